@@ -0,0 +1,739 @@
+#if __has_include("shader_more.hpp")
+#    include "shader_more.hpp"
+#endif
+
+#include "shader.hpp"
+
+#include <w/glsw/profiler.hpp>
+#include <w/now.hpp>
+#include <w/variant.hpp>
+
+#if __has_include(<tbb/global_control.h>)
+#    include <tbb/global_control.h>
+#    define CPP_LIVE_HAVE_TBB_GLOBAL_CONTROL
+#endif
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <execution>
+#include <iostream>
+#include <numbers>
+#include <numeric>
+#include <optional>
+#include <ranges>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+// Renders every shader into memory, no window needed:
+//
+//     benchmark.exe [--size 1920x1080]... [--frames 20] [--threads 8]... [--tile 16x16] [--shader Heat] [--json]
+//                   [--heat-map output/heat-] [--soa] [--interleave 2] [--step-budget 16]
+//     benchmark.exe --check-pack
+//     benchmark.exe --check-math
+//     benchmark.exe --sampling [--size 1920x1080]
+//
+// Sizes and thread counts may be repeated, every combination is measured. Multi-pass
+// pipelines follow the single shaders. --heat-map
+// profiles one more frame per shader and size, writing PREFIX<shader>-<W>x<H>.ppm
+// (false colour cycles per fragment), .csv (the same numbers) and -tiles.csv. --soa shades
+// into a float framebuffer and packs it in a second pass, timing both. --interleave N shades
+// one tile in N per frame, as the GTK host does after T. --step-budget N lets ray marching
+// shaders take N steps per pixel on average each frame, see raymarch::budget; their average
+// and longest rays are in the steps columns. --check-pack runs
+// every 32-bit float pattern through the pack kernel and compares it with std::round.
+// --check-math measures how far glsw::fast and glsw::mediump are from libm, failing where
+// they break the bounds w/math/approximate.hpp documents, and times all three.
+// --sampling times bilinear fetches from a 2048x2048 texture, rotated, in each texel
+// layout; run it under perf stat -e cache-misses to see where the time goes.
+
+auto const my_shaders = std::array
+{
+    W_GLSL_SHADER_AS(heat_dissipation, "Heat"),
+    W_GLSL_SHADER_AS(flying_spiral, "Spiral"),
+    W_GLSL_SHADER_AS(smooth_sine, "Sine"),
+    W_GLSL_SHADER_AS(mandelbrot, "Mandelbrot"),
+    W_GLSL_SHADER_AS(what_is_ray_marching, "Raymarching"),
+    W_GLSL_SHADER_AS(wood_shader_toy, "Toy")
+#if defined(CPP_LIVE_HAVE_MORE_SHADERS)
+    CPP_LIVE_HAVE_MORE_SHADERS
+#endif
+};
+
+struct buffer
+{
+    long                       width;
+    std::vector<std::uint32_t> pixels;
+
+    buffer(w::glsw::SIZE s) : width{s.cx}, pixels(std::size_t(s.cx * s.cy))
+    {
+    }
+
+    auto & operator[](std::size_t y, std::size_t x)
+    {
+        return pixels[y * width + x];
+    }
+};
+
+struct settings
+{
+    std::vector<w::glsw::SIZE> sizes;
+    std::vector<unsigned>      threads; // 0 means whatever the thread pool picks
+    unsigned                   frames = 20;
+    w::glsw::render_options    options;
+    std::string                shader;
+    bool                       json = false;
+    std::string                heat_map; // file name prefix, empty for none
+    bool                       soa = false;
+    bool                       check_pack = false;
+    bool                       check_math = false;
+    bool                       sampling = false;
+    unsigned                   step_budget = 0; // per pixel, 0 for no limit
+};
+
+struct result
+{
+    std::string   shader;
+    w::glsw::SIZE size;
+    unsigned      threads;
+    unsigned      frames;
+    double        mpix_per_s;
+    double        ns_per_pixel;
+    double        p50_ms;
+    double        p99_ms;
+    double        steps_per_ray; // 0 for shaders that don't use raymarch
+    int           max_steps;
+};
+
+auto parse_number(std::string_view s)
+{
+    auto result = unsigned{};
+    auto const [end, error] = std::from_chars(s.data(), s.data() + s.size(), result);
+    return error == std::errc{} && end == s.data() + s.size() ? result : throw std::invalid_argument("not a number: " + std::string{s});
+}
+
+auto parse_size(std::string_view s)
+{
+    auto const x = s.find('x');
+    return x == s.npos ?
+        throw std::invalid_argument("expected WIDTHxHEIGHT: " + std::string{s}) :
+        w::glsw::SIZE{long(parse_number(s.substr(0, x))), long(parse_number(s.substr(x + 1)))};
+}
+
+auto parse(int argc, char * argv[])
+{
+    auto result = settings{};
+
+    for (auto i = 1; i < argc; ++i)
+    {
+        auto const a = std::string_view{argv[i]};
+        auto const next = [&]
+        {
+            return i + 1 < argc ? std::string_view{argv[++i]} : throw std::invalid_argument("missing value for " + std::string{a});
+        };
+
+        if (a == "--size")
+        {
+            result.sizes.push_back(parse_size(next()));
+        }
+        else if (a == "--threads")
+        {
+            result.threads.push_back(parse_number(next()));
+        }
+        else if (a == "--frames")
+        {
+            result.frames = std::max(parse_number(next()), 1u);
+        }
+        else if (a == "--interleave")
+        {
+            result.options.interleave = int(std::max(parse_number(next()), 1u));
+        }
+        else if (a == "--tile")
+        {
+            result.options.tile = parse_size(next());
+        }
+        else if (a == "--shader")
+        {
+            result.shader = next();
+        }
+        else if (a == "--json")
+        {
+            result.json = true;
+        }
+        else if (a == "--check-pack")
+        {
+            result.check_pack = true;
+        }
+        else if (a == "--check-math")
+        {
+            result.check_math = true;
+        }
+        else if (a == "--sampling")
+        {
+            result.sampling = true;
+        }
+        else if (a == "--soa")
+        {
+            result.soa = true;
+        }
+        else if (a == "--step-budget")
+        {
+            result.step_budget = parse_number(next());
+        }
+        else if (a == "--heat-map")
+        {
+            result.heat_map = next();
+        }
+        else
+        {
+            throw std::invalid_argument("unknown option " + std::string{a});
+        }
+    }
+
+    if (result.sizes.empty())
+    {
+        result.sizes = {{640, 360}, {1920, 1080}};
+    }
+    if (result.threads.empty())
+    {
+        result.threads = {0};
+    }
+
+    return result;
+}
+
+auto percentile(std::vector<std::chrono::nanoseconds> sorted, double p)
+{
+    auto const i = std::min(std::size_t(p * sorted.size()), sorted.size() - 1);
+    return std::chrono::duration<double, std::milli>{sorted[i]}.count();
+}
+
+auto name_of(w::glsw::shader const & f)
+{
+    return std::string{f.name};
+}
+
+auto name_of(w::glsw::pipeline const & f)
+{
+    return std::string{f.name()};
+}
+
+auto options_of(w::glsw::shader const & f)
+{
+    return f.options;
+}
+
+auto options_of(w::glsw::pipeline const & f)
+{
+    return f.options();
+}
+
+// program is a shader or a pipeline.
+auto measure(auto & program, w::glsw::SIZE size, unsigned threads, settings const & s)
+{
+#if defined(CPP_LIVE_HAVE_TBB_GLOBAL_CONTROL)
+    auto limit = std::optional<tbb::global_control>{};
+    if (threads)
+    {
+        limit.emplace(tbb::global_control::max_allowed_parallelism, threads);
+    }
+#endif
+
+    auto output = buffer{size};
+    auto framebuffer = w::glsw::framebuffer{};
+
+    // Frames advance at 60 Hz of shader time, the first one is a warm-up and is not counted.
+    auto frame = [&](unsigned i)
+    {
+        auto options = s.options;
+        options.phase = int(i);
+        options.interleave = i ? options.interleave : 1;
+
+        if (s.step_budget)
+        {
+            w::glsw::raymarch::step_budget.reset(std::int64_t(s.step_budget) * size.cx * size.cy);
+        }
+
+        auto const b = w::now();
+        if (s.soa)
+        {
+            w::glsw::render(i / 60.f, {0, 0}, size, program, framebuffer, {0, 0}, options);
+            w::glsw::pack(framebuffer, size, [&](long y) { return &output[std::size_t(y), 0]; }, {.srgb = options_of(program).srgb});
+        }
+        else
+        {
+            w::glsw::render(i / 60.f, {0, 0}, size, program, output, {0, 0}, options);
+        }
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(w::now() - b);
+    };
+
+    frame(0);
+    w::glsw::raymarch::stats.collect();
+
+    auto times = std::vector<std::chrono::nanoseconds>{};
+    for (auto i = 1u; i <= s.frames; ++i)
+    {
+        times.push_back(frame(i));
+    }
+    std::ranges::sort(times);
+    w::glsw::raymarch::step_budget.reset();
+    auto const rays = w::glsw::raymarch::stats.collect();
+
+    auto const total = std::chrono::duration<double>{std::accumulate(times.begin(), times.end(), std::chrono::nanoseconds{})}.count();
+    auto const pixels = double(size.cx) * double(size.cy) * s.frames;
+
+    return result
+    {
+        name_of(program),
+        size,
+        threads,
+        s.frames,
+        pixels / total / 1e6,
+        total * 1e9 / pixels,
+        percentile(times, .5),
+        percentile(times, .99),
+        rays.average(),
+        rays.max
+    };
+}
+
+// What render did before pack_bgra, with NaN defined as 0 since it used to be undefined.
+auto reference_unorm8(float v)
+{
+    return std::isnan(v) ? 0u : std::uint32_t(std::round(std::clamp(v, 0.f, 1.f) * 255.f));
+}
+
+auto check_pack()
+{
+    auto const chunk = std::size_t{1} << 20;
+    auto const chunks = std::views::iota(std::uint64_t{}, (std::uint64_t{1} << 32) / chunk);
+    auto mismatches = std::atomic<std::uint64_t>{};
+
+    std::for_each
+    (
+        std::execution::par,
+        chunks.begin(), chunks.end(),
+        [&](std::uint64_t c)
+        {
+            auto in = std::vector<float>(chunk);
+            auto out = std::vector<std::uint32_t>(chunk);
+            for (auto i = std::size_t{}; i != chunk; ++i)
+            {
+                in[i] = std::bit_cast<float>(std::uint32_t(c * chunk + i));
+            }
+
+            // Offset planes so every channel sees different values and lane positions.
+            auto const n = chunk - 3;
+            w::glsw::pack_bgra(in.data() + 2, in.data() + 1, in.data(), in.data() + 3, out.data(), n);
+
+            auto bad = std::uint64_t{};
+            for (auto i = std::size_t{}; i != n; ++i)
+            {
+                auto const expected =
+                    reference_unorm8(in[i]) | (reference_unorm8(in[i + 1]) << 8) |
+                    (reference_unorm8(in[i + 2]) << 16) | (reference_unorm8(in[i + 3]) << 24);
+                bad += out[i] != expected || w::glsw::unorm8(in[i]) != reference_unorm8(in[i]);
+            }
+            mismatches += bad;
+        }
+    );
+
+    std::cout << "pack_bgra: " << mismatches << " mismatches over all 2^32 floats\n";
+    return mismatches ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+// Worst error of f against exact over every 61st float pattern within [low, high], each
+// divided by what bound allows there, so 1 is right at the bound. unit(r) is what the error
+// counts in where the exact result is r. Results within a factor 2 of leaving the normal
+// range are skipped, and so are NaN results that f gets right.
+auto worst_error(float low, float high, auto f, auto exact, auto unit, auto bound)
+{
+    auto const chunk = std::uint32_t{1} << 20;
+    auto const chunks = std::views::iota(std::uint32_t{}, std::uint32_t(~std::uint32_t{} / chunk + 1));
+    auto worst = std::vector<double>(chunks.size());
+
+    std::for_each
+    (
+        std::execution::par,
+        chunks.begin(), chunks.end(),
+        [&](std::uint32_t c)
+        {
+            for (auto i = c * chunk % 61; i < chunk; i += 61)
+            {
+                auto const x = std::bit_cast<float>(c * chunk + i);
+                if (!(x >= low && x <= high) || std::fpclassify(x) == FP_SUBNORMAL)
+                {
+                    continue;
+                }
+
+                auto const r = exact(double(x));
+                auto const v = double(f(x));
+                if (std::isnan(r))
+                {
+                    worst[c] = std::isnan(v) ? worst[c] : std::numeric_limits<double>::infinity();
+                    continue;
+                }
+                if (std::abs(r) < 0x1p-125 || std::abs(r) > 0x1p127) // within an error of flushing or overflowing
+                {
+                    continue;
+                }
+                worst[c] = std::max(worst[c], std::abs(v - r) / unit(r) / bound(x));
+            }
+        }
+    );
+
+    return std::ranges::max(worst);
+}
+
+// Nanoseconds per call of f over n arguments spread across [low, high].
+auto time_per_call(float low, float high, auto f)
+{
+    auto const n = std::size_t{1} << 16;
+    auto in = std::vector<float>(n);
+    auto out = std::vector<float>(n);
+    for (auto i = std::size_t{}; i != n; ++i)
+    {
+        in[i] = low + (high - low) * float(i * 40503 % n) / float(n);
+    }
+
+    auto const rounds = 32;
+    auto const b = w::now();
+    for (auto k = 0; k != rounds; ++k)
+    {
+        std::transform(in.begin(), in.end(), out.begin(), f);
+        in[k] = out[n - 1 - k]; // keeps the rounds from folding into one
+    }
+    auto const e = w::now();
+    return std::chrono::duration<double, std::nano>{e - b}.count() / double(n * rounds);
+}
+
+auto check_math()
+{
+    // Error in ulp of the result, of 1 for results below 1, and relative to the result, or to 1.
+    auto const ulp = [](double r)
+    {
+        auto const a = float(std::max(std::abs(r), 1e-300));
+        return double(std::nextafter(a, std::numeric_limits<float>::infinity())) - double(a);
+    };
+    auto const ulp_of_1 = [&](double r)
+    {
+        return ulp(std::max(std::abs(r), 1.));
+    };
+    auto const relative = [](double r)
+    {
+        return std::abs(r);
+    };
+    auto const relative_to_1 = [](double r)
+    {
+        return std::max(std::abs(r), 1.);
+    };
+    auto const constant = [](double bound)
+    {
+        return [=](float)
+        {
+            return bound;
+        };
+    };
+    auto const all = std::numeric_limits<float>::max();
+
+    auto failed = false;
+    auto const row = [&](char const * name, float low, float high, auto exact, auto fast, auto mediump, auto unit, auto fast_bound, auto mediump_unit, auto mediump_bound)
+    {
+        auto const f = worst_error(low, high, fast, exact, unit, fast_bound);
+        auto const m = worst_error(low, high, mediump, exact, mediump_unit, mediump_bound);
+        auto const t = [&](auto g)
+        {
+            return time_per_call(std::max(low, -1e4f), std::min(high, 1e4f), g);
+        };
+        failed = failed || !(f <= 1) || !(m <= 1);
+
+        std::cout
+            << std::left << std::setw(14) << name
+            << std::right << std::fixed << std::setprecision(2)
+            << std::setw(10) << f
+            << std::setw(10) << m
+            << std::setw(10) << t([&](float x) { return float(exact(double(x))); })
+            << std::setw(10) << t(fast)
+            << std::setw(10) << t(mediump)
+            << (f <= 1 && m <= 1 ? "" : "  FAILED")
+            << "\n";
+    };
+
+    std::cout
+        << "worst error as a fraction of the documented bound, time in ns per call\n"
+        << std::left << std::setw(14) << "function"
+        << std::right << std::setw(10) << "fast" << std::setw(10) << "mediump"
+        << std::setw(10) << "libm" << std::setw(10) << "fast" << std::setw(10) << "mediump"
+        << "\n";
+
+    using namespace w::glsw;
+    auto const s = [](double x) { return std::sin(x); };
+    auto const c = [](double x) { return std::cos(x); };
+    row("exp", -100, 100, [](double x) { return std::exp(x); }, [](float x) { return fast::exp(x); }, [](float x) { return mediump::exp(x); }, ulp, constant(1), relative, constant(0x1p-13));
+    row("log", 0, all, [](double x) { return std::log(x); }, [](float x) { return fast::log(x); }, [](float x) { return mediump::log(x); }, ulp, constant(1), relative_to_1, constant(0x1p-12));
+    row("sin", -1024, 1024, s, [](float x) { return fast::sin(x); }, [](float x) { return mediump::sin(x); }, ulp_of_1, constant(1), relative_to_1, constant(0x1p-11));
+    row("sin 2^16", -0x1p16f, 0x1p16f, s, [](float x) { return fast::sin(x); }, [](float x) { return mediump::sin(x); }, ulp_of_1, constant(16), relative_to_1, constant(0x1p-11));
+    row("cos", -1024, 1024, c, [](float x) { return fast::cos(x); }, [](float x) { return mediump::cos(x); }, ulp_of_1, constant(1), relative_to_1, constant(0x1p-11));
+    row("cos 2^16", -0x1p16f, 0x1p16f, c, [](float x) { return fast::cos(x); }, [](float x) { return mediump::cos(x); }, ulp_of_1, constant(16), relative_to_1, constant(0x1p-11));
+    row("atan", -all, all, [](double x) { return std::atan(x); }, [](float x) { return fast::atan(x); }, [](float x) { return mediump::atan(x); }, ulp, constant(3), relative, constant(0x1p-15));
+    row("tanh", -all, all, [](double x) { return std::tanh(x); }, [](float x) { return fast::tanh(x); }, [](float x) { return mediump::tanh(x); }, ulp, constant(2), relative, constant(0x1p-13));
+
+    for (auto const y : {-1.5f, .5f, 1.2f, 2.2f, 10.f, 64.f})
+    {
+        auto const name = "pow x " + std::to_string(y).substr(0, 4);
+        auto const size = [=](float x)
+        {
+            return std::abs(double(y) * std::log(double(x)));
+        };
+        row
+        (
+            name.c_str(), 0, all,
+            [=](double x) { return std::pow(x, double(y)); },
+            [=](float x) { return fast::pow(x, y); },
+            [=](float x) { return mediump::pow(x, y); },
+            ulp, [=](float x) { return 3 + 2 * size(x); },
+            relative, [=](float x) { return 0x1p-11 * (1 + size(x)); }
+        );
+    }
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+auto sampling(settings const & s)
+{
+    auto const n = std::size_t{2048};
+    auto pixels = std::vector<std::uint32_t>(n * n);
+    for (auto i = std::size_t{}; i != pixels.size(); ++i)
+    {
+        pixels[i] = std::uint32_t(i * 2654435761u);
+    }
+
+    std::cout
+        << std::left << std::setw(10) << "layout"
+        << std::right << std::setw(8) << "angle"
+        << std::setw(12) << "ns/sample"
+        << "\n";
+
+    for (auto const layout : {w::glsw::texel_layout::linear, w::glsw::texel_layout::blocks})
+    {
+        auto texture = w::glsw::sampler2D{};
+        texture.assign(n, n, pixels.data(), n, layout);
+
+        for (auto const degrees : {0, 45, 90})
+        {
+            // One texel per pixel, so level 0 is the right one and every fetch is a new texel.
+            auto const [width, height] = s.sizes.front();
+            auto const a = float(degrees) * std::numbers::pi_v<float> / 180;
+            auto const c = std::cos(a) / float(n);
+            auto const d = std::sin(a) / float(n);
+
+            auto sum = 0.f;
+            auto const b = w::now();
+            for (auto y = 0l; y != height; ++y)
+            {
+                for (auto x = 0l; x != width; ++x)
+                {
+                    auto const uv = w::glsw::vec2{x * c - y * d, x * d + y * c};
+                    sum += w::glsw::textureLod(texture, uv, 0.f).x;
+                }
+            }
+            auto const e = w::now();
+
+            std::cout
+                << std::left << std::setw(10) << (layout == w::glsw::texel_layout::linear ? "linear" : "blocks")
+                << std::right << std::setw(8) << degrees
+                << std::fixed << std::setprecision(2)
+                << std::setw(12) << std::chrono::duration<double, std::nano>{e - b}.count() / (double(width) * double(height))
+                << (sum < 0 ? " " : "") // keeps the loop alive
+                << "\n";
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+auto write_heat_map(w::glsw::shader const & shader, w::glsw::SIZE size, settings const & s)
+{
+    auto output = buffer{size};
+    auto tiles = w::glsw::tile_profile{};
+    auto pixels = w::glsw::pixel_profile{};
+    auto options = s.options;
+    options.profile = &tiles;
+    options.pixels = &pixels;
+
+    w::glsw::render(1.f, {0, 0}, size, shader, output, {0, 0}, options);
+
+    auto const name = s.heat_map + shader.name + "-" + std::to_string(size.cx) + "x" + std::to_string(size.cy);
+    auto open = [](std::string const & path)
+    {
+        auto result = std::ofstream{path, std::ios::binary};
+        return result ? std::move(result) : throw std::runtime_error("cannot write " + path);
+    };
+
+    auto ppm = open(name + ".ppm");
+    w::glsw::write_heat_map(ppm, pixels);
+    auto csv = open(name + ".csv");
+    w::glsw::write_csv(csv, pixels);
+    auto tiles_csv = open(name + "-tiles.csv");
+    w::glsw::write_csv(tiles_csv, tiles);
+}
+
+auto print_table(std::vector<result> const & results)
+{
+    std::cout
+        << std::left << std::setw(16) << "shader"
+        << std::right << std::setw(12) << "size"
+        << std::setw(9) << "threads"
+        << std::setw(10) << "Mpix/s"
+        << std::setw(10) << "ns/pix"
+        << std::setw(10) << "p50 ms"
+        << std::setw(10) << "p99 ms"
+        << std::setw(14) << "steps"
+        << "\n";
+
+    for (auto const & r : results)
+    {
+        auto size = std::ostringstream{};
+        size << r.size.cx << "x" << r.size.cy;
+
+        auto steps = std::ostringstream{};
+        steps << std::fixed << std::setprecision(1) << r.steps_per_ray << "/" << r.max_steps;
+
+        std::cout
+            << std::left << std::setw(16) << r.shader
+            << std::right << std::setw(12) << size.str()
+            << std::setw(9) << (r.threads ? std::to_string(r.threads) : "all")
+            << std::fixed << std::setprecision(2)
+            << std::setw(10) << r.mpix_per_s
+            << std::setw(10) << r.ns_per_pixel
+            << std::setw(10) << r.p50_ms
+            << std::setw(10) << r.p99_ms
+            << std::setw(14) << (r.max_steps ? steps.str() : "-")
+            << "\n";
+    }
+}
+
+auto print_json(std::vector<result> const & results)
+{
+    std::cout << "[\n";
+    auto first = true;
+    for (auto const & r : results)
+    {
+        std::cout
+            << (std::exchange(first, false) ? "" : ",\n")
+            << "  {"
+            << "\"shader\": \"" << r.shader << "\", "
+            << "\"width\": " << r.size.cx << ", "
+            << "\"height\": " << r.size.cy << ", "
+            << "\"threads\": " << r.threads << ", "
+            << "\"frames\": " << r.frames << ", "
+            << "\"mpix_per_s\": " << r.mpix_per_s << ", "
+            << "\"ns_per_pixel\": " << r.ns_per_pixel << ", "
+            << "\"p50_ms\": " << r.p50_ms << ", "
+            << "\"p99_ms\": " << r.p99_ms << ", "
+            << "\"steps_per_ray\": " << r.steps_per_ray << ", "
+            << "\"max_steps\": " << r.max_steps
+            << "}";
+    }
+    std::cout << "\n]\n";
+}
+
+auto on_exception(char const * e)
+{
+    std::fprintf(stderr, "C++Live benchmark: error: %s\n", e);
+    return EXIT_FAILURE;
+}
+
+auto main(int argc, char * argv[]) -> int
+try
+{
+    auto const s = parse(argc, argv);
+
+    if (s.check_pack)
+    {
+        return check_pack();
+    }
+    if (s.check_math)
+    {
+        return check_math();
+    }
+    if (s.sampling)
+    {
+        return sampling(s);
+    }
+
+    if (w::get_variant() == w::variant::debug && !s.json)
+    {
+        std::cout << "WARNING: [" << w::get_variant_str() << "] build, numbers are not representative\n";
+    }
+
+    auto results = std::vector<result>{};
+    for (auto const & shader : my_shaders)
+    {
+        if (!s.shader.empty() && s.shader != shader.name)
+        {
+            continue;
+        }
+        for (auto const size : s.sizes)
+        {
+            for (auto const threads : s.threads)
+            {
+                results.push_back(measure(shader, size, threads, s));
+            }
+            if (!s.heat_map.empty())
+            {
+                write_heat_map(shader, size, s);
+            }
+        }
+    }
+
+    // Multi-pass programs keep state between frames, so each measurement starts afresh.
+    for (auto const make : {&feedback_trail::make_pipeline})
+    {
+        if (!s.shader.empty() && s.shader != make().name())
+        {
+            continue;
+        }
+        for (auto const size : s.sizes)
+        {
+            for (auto const threads : s.threads)
+            {
+                auto program = make();
+                results.push_back(measure(program, size, threads, s));
+            }
+        }
+    }
+
+    if (s.json)
+    {
+        print_json(results);
+    }
+    else
+    {
+        print_table(results);
+    }
+
+    return EXIT_SUCCESS;
+}
+catch(std::exception const & e)
+{
+    return on_exception(e.what());
+}
+catch(...)
+{
+    return on_exception("unknown");
+}
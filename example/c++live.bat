@@ -13,6 +13,8 @@ if "%1" == "detect_git" (
     call :detect_llvm
 ) else if "%1" == "detect_msvc" (
     call :detect_msvc
+) else if "%1" == "benchmark" (
+    call :benchmark %*
 ) else (
     call :build %1 %VARIANT%
 )
@@ -64,17 +66,7 @@ if exist "%VSWHERE_EXE%" (
 rem echo Found %VCVARSALL%
 exit /B 0
 
-:build
-
-cd /D "%~dp0"
-
-if exist output\ (
-    rem
-) else (
-    mkdir output
-)
-
-
+:setup_msvc
 where /q cl.exe
 if ERRORLEVEL 1 (
     rem echo cl.exe not found yet
@@ -96,6 +88,48 @@ if ERRORLEVEL 1 (
 ) else (
     rem echo Found cl.exe
 )
+exit /B 0
+
+:benchmark
+
+rem Before shift, which moves %0 along with the rest.
+cd /D "%~dp0"
+
+rem Everything after "benchmark" goes to benchmark.exe, like "$@" in c++live.sh.
+shift
+set BENCHMARK_ARGS=
+:benchmark_args
+if not "%~1" == "" (
+    set BENCHMARK_ARGS=!BENCHMARK_ARGS! %1
+    shift
+    goto :benchmark_args
+)
+
+if exist output\ (
+    rem
+) else (
+    mkdir output
+)
+
+call :setup_msvc || exit /b 1
+
+rem Always optimized, debug numbers are meaningless
+cl.exe /O2 /DNDEBUG /nologo /I. /DNOMINMAX /EHsc /permissive- /Zc:preprocessor /Zc:__cplusplus /std:c++latest /utf-8 /fp:strict benchmark.cpp /Fooutput/benchmark.obj /Feoutput/benchmark.exe || exit /b 1
+output\benchmark.exe !BENCHMARK_ARGS!
+exit /b !errorlevel!
+
+:build
+
+cd /D "%~dp0"
+
+if exist output\ (
+    rem
+) else (
+    mkdir output
+)
+
+
+call :setup_msvc || exit /b 1
 
 if exist cut\ (
   rem echo Found Cut! sources
@@ -91,10 +91,56 @@ build()
     fi
 }
 
+benchmark()
+{
+    cd "$(dirname "$0")"
+
+    mkdir -p output
+
+    detect_llvm
+
+    # Always optimized, debug numbers are meaningless
+    clang++ -O3 -DNDEBUG -std=c++2c benchmark.cpp -o output/benchmark.exe -ltbb
+
+    shift
+    output/benchmark.exe "$@"
+}
+
+# Swizzles are constexpr members that should fold into register moves. Compiles a few
+# functions that only swizzle, through pointers so that no argument passing is in the way,
+# and fails if any of them calls out or touches the stack.
+check_swizzle()
+{
+    cd "$(dirname "$0")"
+
+    mkdir -p output
+
+    detect_llvm
+
+    clang++ -O2 -std=c++2c -I. -S -x c++ - -o output/check-swizzle.s <<'EOF'
+#include <w/glsw.hpp>
+using namespace w::glsw;
+extern "C" void swizzle_read(vec4 const * v, vec4 * o) { *o = v->wzyx(); }
+extern "C" void swizzle_read_chain(vec3 const * v, vec3 * o) { *o = v->zxy().yx().xyy(); }
+extern "C" void swizzle_write(vec4 * v, vec2 const * a) { v->zx(*a); }
+extern "C" void swizzle_write_rgba(vec4 * v, vec3 const * a, vec2 * o) { *o = v->bgr(*a).xy() + v->ar(); }
+EOF
+
+    if awk '/^_?swizzle_[a-z_]+:/ { f = 1 } f; /\.cfi_endproc/ { f = 0 }' output/check-swizzle.s | grep -E 'call|jmp[[:space:]]+[_A-Za-z]|rsp'; then
+        echo "error: swizzles don't compile to register moves, see output/check-swizzle.s"
+        return 1
+    fi
+    echo "Complete"
+}
+
 if [ "$1" = "detect_git" ]; then
     detect_git
 elif [ "$1" = "detect_llvm" ]; then
     detect_llvm
+elif [ "$1" = "benchmark" ]; then
+    benchmark "$@"
+elif [ "$1" = "check_swizzle" ]; then
+    check_swizzle
 else
     build $1
 fi
@@ -4,25 +4,44 @@
 
 #include "shader.hpp"
 
+#include <w/glsw/accumulator.hpp>
+#include <w/glsw/ppm.hpp>
+#include <w/glsw/profiler.hpp>
+#include <w/glsw/raymarch.hpp>
+#include <w/glsw/texture_cache.hpp>
 #include <w/now.hpp>
 #include <w/variant.hpp>
 
 #include <cairomm/context.h>
 #include <cairomm/surface.h>
+#include <gdkmm/pixbuf.h>
+#include <glibmm/dispatcher.h>
 #include <gtkmm/application.h>
 #include <gtkmm/drawingarea.h>
 #include <gtkmm/window.h>
 #include <gtkmm.h>
 
+#include <array>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <thread>
 #include <vector>
 
 #include <cmath>
 #include <cstdint>
+#include <utility>
 
 namespace demo
 {
     USING_W_GLSW
 
+    inline constexpr auto options = shader_options{.uses_iDate = false};
+
     inline auto mainImage(vec2 fragCoord)
     {
         auto const uv = (fragCoord - 0.5 * iResolution.xy()) / iResolution.y * 3;
@@ -34,34 +53,136 @@ namespace demo
 
 auto const my_shaders = std::array        //
     {                                     //
-     std::pair{&demo::mainImage, "Demo"}, //
-     // std::pair{&wood_shader_toy::mainImage, "Toy"},
-     std::pair{&heat_dissipation::mainImage, "Heat"},
-     std::pair{&flying_spiral::mainImage, "Spiral"},
-     std::pair{&smooth_sine::mainImage, "Sine"},
-     std::pair{&what_is_ray_marching::mainImage, "Raymarching"}
+     W_GLSL_SHADER_AS(demo, "Demo"),      //
+     // W_GLSL_SHADER_AS(wood_shader_toy, "Toy"),
+     W_GLSL_SHADER_AS(heat_dissipation, "Heat"),
+     W_GLSL_SHADER_AS(flying_spiral, "Spiral"),
+     W_GLSL_SHADER_AS(smooth_sine, "Sine"),
+     W_GLSL_SHADER_AS(mandelbrot, "Mandelbrot"),
+     W_GLSL_SHADER_AS(what_is_ray_marching, "Raymarching")
 #if defined(CPP_LIVE_HAVE_MORE_SHADERS)
      CPP_LIVE_HAVE_MORE_SHADERS
 #endif
     };
 
+// Decoded textures are cached under output/, so relaunches after an edit just map them.
+// Otherwise PPM files are decoded from the mapped bytes and anything else goes through
+// gdk-pixbuf. Either way texels go straight into the sampler and the mips are built in
+// parallel.
+auto load_to_ichannel(w::glsw::sampler2D & s, std::filesystem::path const & path)
+{
+    w::glsw::load_cached
+    (
+        s, path, "output", w::glsw::texel_layout::blocks,
+        [&](w::glsw::sampler2D & s, std::span<std::byte const> bytes, w::glsw::texel_layout layout)
+        {
+            if (path.extension() == ".ppm")
+            {
+                w::glsw::load_ppm(s, bytes, layout);
+                return;
+            }
+
+            auto const picture = Gdk::Pixbuf::create_from_file(path.string());
+            if (picture->get_bits_per_sample() != 8)
+            {
+                throw std::runtime_error("unsupported image format: " + path.string());
+            }
+
+            auto const pixels   = picture->get_pixels();
+            auto const stride   = std::size_t(picture->get_rowstride());
+            auto const channels = std::size_t(picture->get_n_channels());
+            auto const alpha    = picture->get_has_alpha();
+
+            s.assign
+            (
+                std::size_t(picture->get_width()), std::size_t(picture->get_height()),
+                [=](std::size_t x, std::size_t y)
+                {
+                    auto const p = pixels + y * stride + x * channels;
+                    return w::glsw::vec4{p[0] / 255.f, p[1] / 255.f, p[2] / 255.f, alpha ? p[3] / 255.f : 1.f};
+                },
+                layout
+            );
+        }
+    );
+}
+
 class drawing_area : public Gtk::DrawingArea
 {
+public:
+    struct frame_pacing
+    {
+        double max_fps   = 60;   // 0 renders on every frame clock tick
+        bool   on_demand = true; // render only when the shader reads iTime or its input changed
+    };
+
+private:
+    struct frame_request
+    {
+        int                     width;
+        int                     height;
+        std::size_t             shader;
+        w::glsw::render_options options;
+        unsigned                step_budget; // ray marching steps per pixel, 0 for no limit
+        bool                    profile;
+        std::optional<float>    still; // frozen time while a high quality still converges
+    };
+
+    using surface_type = Cairo::RefPtr<Cairo::ImageSurface>;
+
     decltype(w::now()) started_at;
     decltype(w::now()) last_fps_time;
     unsigned           frame_count;
+    std::chrono::nanoseconds shading_time; // spent by the worker on shaded_frames
+    unsigned           shaded_frames; // since last_fps_time, without stills
     using fps_callback_type = std::function<void(unsigned)>;
     fps_callback_type  fps_callback;
     std::size_t        current_shader;
+    w::glsw::render_options render_options;
+    unsigned                step_budget; // see frame_request
+    w::glsw::render_stats   render_stats;
+    std::optional<std::chrono::nanoseconds> render_time; // of the last frame, shading and packing, empty for a still
+    w::glsw::raymarch::counters rays; // of the last frame, empty unless the shader marches with raymarch
+    std::optional<w::glsw::dynamic_scale> dynamic_scale; // empty to always render at full size
+    w::glsw::profiler   profiler;
+    frame_pacing        pacing;
+    std::int64_t        last_request_time; // frame clock time, microseconds
+    std::pair<int, int> requested_size;
+    bool                in_flight;
+    bool                dirty;
+    std::optional<float> still_time;
+
+    // The worker renders into the back surface while GTK paints the front one. Both are
+    // kept across frames and only recreated when the allocation size changes.
+    mutable std::mutex           mutex;
+    std::condition_variable_any  wake;
+    std::optional<frame_request> request;
+    std::array<surface_type, 2>  surfaces; // front, back
+    w::glsw::framebuffer         framebuffer; // worker only, shaded before packing into the back surface
+    std::optional<std::size_t>   framebuffer_shader; // worker only, whose pixels interleaved frames reuse
+    w::glsw::accumulator         still{64}; // worker only
+    std::optional<float>         still_shaded; // worker only, the time still holds samples of
+    std::pair<int, int>          still_progress; // samples, wanted
+    Glib::Dispatcher             frame_ready;
+    std::jthread                 worker;
 
 public:
     drawing_area() : //
-        started_at(w::now()), last_fps_time(started_at), frame_count{}, fps_callback{}, current_shader{}
+        started_at(w::now()), last_fps_time(started_at), frame_count{}, shading_time{}, shaded_frames{}, fps_callback{}, current_shader{}, render_options{}, step_budget{}, render_stats{}, render_time{}, rays{}, dynamic_scale{std::in_place},
+        profiler{std::size(my_shaders)}, pacing{}, last_request_time{}, requested_size{}, in_flight{}, dirty{true}, still_time{},
+        mutex{}, wake{}, request{}, surfaces{}, framebuffer{}, framebuffer_shader{}, still_progress{}, frame_ready{}, worker{[this](std::stop_token stop) { run(stop); }}
     {
-        Glib::signal_idle().connect(sigc::mem_fun(*this, &drawing_area::on_idle));
+        frame_ready.connect(sigc::mem_fun(*this, &drawing_area::on_frame_ready));
+        add_tick_callback(sigc::mem_fun(*this, &drawing_area::on_tick));
         add_events(Gdk::SCROLL_MASK | Gdk::BUTTON_PRESS_MASK);
     }
 
+    void set_frame_pacing(frame_pacing p)
+    {
+        pacing = p;
+        dirty  = true;
+    }
+
     void set_fps_callback(fps_callback_type callback)
     {
         fps_callback = std::move(callback);
@@ -72,11 +193,73 @@ public:
         return current_shader;
     }
 
+    auto get_render_stats() const
+    {
+        auto const lock = std::lock_guard{mutex};
+        return render_stats;
+    }
+
+    auto get_ray_stats() const
+    {
+        auto const lock = std::lock_guard{mutex};
+        return rays;
+    }
+
+    auto const & get_profiler() const
+    {
+        return profiler;
+    }
+
+    void toggle_profiler()
+    {
+        profiler.toggle();
+        dirty = true;
+    }
+
+    // Cycles through shading every tile, every 2nd and every 4th per frame.
+    void cycle_interleave()
+    {
+        render_options.interleave = render_options.interleave < 4 ? render_options.interleave * 2 : 1;
+        dirty                     = true;
+    }
+
+    auto get_interleave() const
+    {
+        return render_options.interleave;
+    }
+
+    // Cycles through no limit, 32, 16 and 8 ray marching steps per pixel and frame.
+    void cycle_step_budget()
+    {
+        step_budget = step_budget == 0 ? 32 : step_budget > 8 ? step_budget / 2 : 0;
+        dirty       = true;
+    }
+
+    auto get_step_budget() const
+    {
+        return step_budget;
+    }
+
+    // Freezes time and converges on a 64 sample still with motion blur, written under
+    // output/ once it is done. Again goes back to live rendering.
+    void toggle_still()
+    {
+        still_time = still_time ? std::nullopt : std::optional{elapsed()};
+        dirty      = true;
+    }
+
+    auto get_still_progress() const -> std::optional<std::pair<int, int>>
+    {
+        auto const lock = std::lock_guard{mutex};
+        return still_time ? std::optional{still_progress} : std::nullopt;
+    }
+
 protected:
     auto update_current_shader_index(bool forward)
     {
         auto const S   = std::size(my_shaders);
         current_shader = (current_shader + S + forward * 2 - 1) % S;
+        dirty          = true;
     }
 
     bool on_scroll_event(GdkEventScroll * e) override
@@ -91,58 +274,209 @@ protected:
         return true;
     }
 
-    void render_current_shader(auto & s)
+    auto elapsed() const -> float
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(w::now() - started_at).count() / 1e9f;
+    }
+
+    auto render_still(float time, std::size_t shader, bool switched, w::glsw::SIZE size, w::glsw::render_options const & options)
+    {
+        if (switched || still_shaded != time)
+        {
+            still.reset(still.wanted());
+            still.shutter = 1 / 60.f;
+            still_shaded  = time;
+        }
+
+        auto const before = still.samples();
+        auto const stats  = still.render(time, {0, 0}, size, my_shaders[shader], {0, 0}, options);
+
+        if (still.done() && still.samples() != before)
+        {
+            auto const path = std::filesystem::path{"output"} / (std::string{my_shaders[shader].name} + "-" + std::to_string(size.cx) + "x" + std::to_string(size.cy) + ".ppm");
+            auto error      = std::error_code{};
+            std::filesystem::create_directories(path.parent_path(), error);
+            if (auto file = std::ofstream{path, std::ios::binary})
+            {
+                w::glsw::save_ppm(file, still.image(), my_shaders[shader].options.srgb);
+            }
+        }
+
+        return stats;
+    }
+
+    auto render_shader(surface_type const & s, frame_request const & r)
     {
         auto const w = s->get_width();
         auto const h = s->get_height();
 
-        if (!w || !h) return;
+        if (!w || !h) return std::pair{w::glsw::render_stats{r.options.tile, 0, 1, 1.f}, std::chrono::nanoseconds{}};
+
+        // Cairo rows run top down, glsw ones bottom up.
+        auto const data   = s->get_data();
+        auto const stride = s->get_stride();
+        auto const row    = [&](long i) { return reinterpret_cast<std::uint32_t *>(data + (h - 1 - i) * stride); };
+
+        auto tiles   = w::glsw::tile_profile{};
+        auto options = r.options;
+        if (r.profile)
+        {
+            options.profile = &tiles;
+        }
+        auto const switched = framebuffer_shader != r.shader;
+        if (switched)
+        {
+            options.interleave = 1; // the kept tiles belong to another shader
+        }
+        framebuffer_shader = r.shader;
+
+        // A still converges at full quality, the budget is for keeping up with live frames.
+        if (r.step_budget && !r.still)
+        {
+            w::glsw::raymarch::step_budget.reset(std::int64_t(r.step_budget) * w * h);
+        }
+        else
+        {
+            w::glsw::raymarch::step_budget.reset();
+        }
+
+        auto const b     = w::now();
+        auto const stats = r.still ?
+            render_still(*r.still, r.shader, switched, {w, h}, options) :
+            w::glsw::render(elapsed(), {0, 0}, {w, h}, my_shaders[r.shader], framebuffer, {0, 0}, options);
+        w::glsw::pack(r.still ? still.image() : framebuffer, {w, h}, row, {.mask = 0xff000000, .srgb = my_shaders[r.shader].options.srgb});
+        auto const e     = w::now();
 
-        struct output_type
+        if (r.profile)
         {
-            unsigned char * p;
-            int             s;
-            int             h;
+            profiler.record(r.shader, e - b, std::move(tiles));
 
-            struct color_convert
+            struct pixels_type
             {
-                unsigned int * value;
+                decltype(row) const & rows;
 
-                auto operator=(std::uint32_t c) const
+                auto & operator[](std::size_t y, std::size_t x)
                 {
-                    *value = 0xff000000 | c;
+                    return rows(long(y))[x];
                 }
-            };
+            } pixels{row};
 
-            color_convert operator[](std::size_t y, std::size_t x)
+            auto const [history, last] = profiler.get(r.shader);
+            w::glsw::draw_profile({0, 0}, last, history, pixels);
+        }
+
+        return std::pair{stats, std::chrono::nanoseconds{e - b}};
+    }
+
+    void run(std::stop_token stop)
+    {
+        for (;;)
+        {
+            auto r    = frame_request{};
+            auto back = surface_type{};
             {
-                y = h - 1 - y;
-                auto const o = reinterpret_cast<unsigned int *>(p + y * s);
-                return color_convert{o + x};
+                auto lock = std::unique_lock{mutex};
+                if (!wake.wait(lock, stop, [this] { return request.has_value(); }))
+                {
+                    return;
+                }
+                r    = *std::exchange(request, std::nullopt);
+                back = surfaces[1];
             }
-        } output(s->get_data(), s->get_stride(), h);
 
-        auto const time = std::chrono::duration_cast<std::chrono::nanoseconds>(w::now() - started_at).count() / 1e9f;
-        w::glsw::render(time, {0, 0}, {w, h}, my_shaders[current_shader].first, output, {0, 0});
+            if (!back || back->get_width() != r.width || back->get_height() != r.height)
+            {
+                back = Cairo::ImageSurface::create(Cairo::FORMAT_ARGB32, r.width, r.height);
+            }
+
+            back->flush();
+            auto const [stats, spent] = render_shader(back, r);
+            auto const steps = w::glsw::raymarch::stats.collect();
+            back->mark_dirty();
+
+            {
+                auto const lock = std::lock_guard{mutex};
+                surfaces[1]     = std::move(surfaces[0]);
+                surfaces[0]     = std::move(back);
+                render_stats    = stats;
+                render_time     = r.still ? std::nullopt : std::optional{spent};
+                rays            = steps;
+                still_progress  = {still.samples(), still.wanted()};
+            }
+            frame_ready.emit();
+        }
     }
 
     bool on_draw(Cairo::RefPtr<Cairo::Context> const & c) override
     {
-        auto const a = get_allocation();
-        auto s = Cairo::ImageSurface::create(Cairo::FORMAT_ARGB32, a.get_width(), a.get_height());
+        auto front = surface_type{};
+        {
+            auto const lock = std::lock_guard{mutex};
+            front           = surfaces[0];
+        }
 
-        render_current_shader(s);
+        if (front)
+        {
+            c->set_source(front, 0, 0);
+            c->paint();
+        }
 
-        s->mark_dirty();
+        return true;
+    }
 
-        c->set_source(s, 0, 0);
-        c->paint();
+    // Frames are paced by the frame clock, which also stops ticking while the window is
+    // hidden. Requests come only from here, on the GUI thread, and never while a frame is
+    // in flight, so the worker never reuses a surface that on_draw is still painting.
+    bool on_tick(Glib::RefPtr<Gdk::FrameClock> const & clock)
+    {
+        auto const a    = get_allocation();
+        auto const size = std::pair{a.get_width(), a.get_height()};
+        dirty           = dirty || size != requested_size;
 
-        update_fps();
+        auto const progress   = get_still_progress(); // the worker writes it while a frame is in flight
+        auto const converging = progress && progress->first < progress->second;
+        auto const animated   = (my_shaders[current_shader].options.uses_iTime && !still_time) || !pacing.on_demand;
+        auto const now      = clock->get_frame_time();
+        auto const due      = pacing.max_fps <= 0 || now - last_request_time >= 1e6 / pacing.max_fps;
+
+        if (!in_flight && (animated || converging || dirty) && due)
+        {
+            // A still image is shaded in full, there is no next frame to fill in the rest.
+            auto options       = render_options;
+            options.interleave = animated ? options.interleave : 1;
+            render_options.phase++;
+            {
+                auto const lock = std::lock_guard{mutex};
+                request         = frame_request{size.first, size.second, current_shader, options, step_budget, profiler.enabled(), still_time};
+            }
+            wake.notify_one();
+
+            in_flight         = true;
+            dirty             = false;
+            requested_size    = size;
+            last_request_time = now;
+        }
 
         return true;
     }
 
+    void on_frame_ready()
+    {
+        in_flight = false;
+        {
+            // Samples of a still are shaded in full whatever the scale, they say nothing
+            // about the cost of an animated frame.
+            auto const lock = std::lock_guard{mutex};
+            if (render_time)
+            {
+                shading_time += *render_time;
+                shaded_frames++;
+            }
+        }
+        update_fps();
+        queue_draw();
+    }
+
     void update_fps()
     {
         frame_count++;
@@ -152,7 +486,17 @@ protected:
         if (since_last_fps.count() >= .3)
         {
             auto fps = frame_count / since_last_fps.count();
+            if (dynamic_scale && shaded_frames)
+            {
+                // What shading took, not the time between frames, which includes waiting
+                // for the frame clock and the frame rate cap.
+                auto const scale     = dynamic_scale->update(shading_time / shaded_frames);
+                dirty                = dirty || scale != render_options.scale;
+                render_options.scale = scale;
+            }
             frame_count = 0;
+            shading_time = {};
+            shaded_frames = 0;
             last_fps_time = now;
             if (fps_callback)
             {
@@ -160,12 +504,6 @@ protected:
             }
         }
     }
-
-    bool on_idle()
-    {
-        queue_draw();
-        return true;
-    }
 };
 
 class MainWindow : public Gtk::Window
@@ -199,6 +537,7 @@ public:
             {
                 auto const v = w::get_variant_str();
                 auto const i = drawing_area.get_current_shader_index();
+                auto const s = drawing_area.get_render_stats();
                 auto oss = std::ostringstream{};
                 oss 
                     << 
@@ -207,9 +546,33 @@ public:
                         std::string{'['} + v + "] " :
                         ""
                     )
-                    << my_shaders[i].second << " "
+                    << my_shaders[i].name << " "
                     << "(" << (i + 1) << "/" << std::size(my_shaders) << ") "
-                    << "FPS: " << static_cast<int>(fps);
+                    << "FPS: " << static_cast<int>(fps) << " "
+                    << "Tile: " << s.tile.cx << "x" << s.tile.cy << "/" << s.packet << " "
+                    << "Scale: " << std::lround(s.scale * 100) << "%";
+
+                if (auto const rays = drawing_area.get_ray_stats(); rays.rays)
+                {
+                    oss << " Steps: " << std::fixed << std::setprecision(1) << rays.average() << "/" << rays.max;
+                }
+                if (auto const still = drawing_area.get_still_progress())
+                {
+                    oss << " Still: " << still->first << "/" << still->second;
+                }
+                if (drawing_area.get_interleave() > 1)
+                {
+                    oss << " Interleave: 1/" << drawing_area.get_interleave();
+                }
+                if (drawing_area.get_step_budget())
+                {
+                    oss << " Budget: " << drawing_area.get_step_budget();
+                }
+
+                if (drawing_area.get_profiler().enabled())
+                {
+                    oss << " " << drawing_area.get_profiler().summary(i);
+                }
 
                 this->set_title(oss.str());
             }
@@ -223,6 +586,35 @@ protected:
         position_window();
     }
 
+    // P toggles the profiler: tile heat map and frame time histogram over the image,
+    // percentiles in the title. T trades quality for speed by shading only some of the
+    // tiles each frame. H stops the clock and converges on a high quality still. B caps the
+    // steps ray marching shaders take per frame, see raymarch::budget.
+    bool on_key_press_event(GdkEventKey * e) override
+    {
+        if (e->keyval == GDK_KEY_p || e->keyval == GDK_KEY_P)
+        {
+            drawing_area.toggle_profiler();
+            return true;
+        }
+        if (e->keyval == GDK_KEY_t || e->keyval == GDK_KEY_T)
+        {
+            drawing_area.cycle_interleave();
+            return true;
+        }
+        if (e->keyval == GDK_KEY_h || e->keyval == GDK_KEY_H)
+        {
+            drawing_area.toggle_still();
+            return true;
+        }
+        if (e->keyval == GDK_KEY_b || e->keyval == GDK_KEY_B)
+        {
+            drawing_area.cycle_step_budget();
+            return true;
+        }
+        return Gtk::Window::on_key_press_event(e);
+    }
+
     bool on_delete_event(GdkEventAny* event) override
     {
         std::exit(0);
@@ -260,6 +652,7 @@ auto main(int argc, char * argv[]) /*noexcept*/ -> int
 try
 {
     auto const app    = Gtk::Application::create(argc, argv, "org.gtkmm.example.cpp-live");
+    // load_to_ichannel(w::glsw::channel_textures[0], "THE-IMAGE.png");
     auto       window = MainWindow{};
     return app->run(window);
 }
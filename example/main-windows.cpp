@@ -5,6 +5,9 @@
 #include "shader.hpp"
 
 #include <w/glsw.hpp>
+#include <w/glsw/profiler.hpp>
+#include <w/glsw/raymarch.hpp>
+#include <w/glsw/texture_cache.hpp>
 #include <w/now.hpp> 
 #include <w/variant.hpp>
 #include <w/windows/basic_window.hpp>
@@ -16,6 +19,7 @@
 #include <array>
 #include <chrono>
 #include <exception>
+#include <execution>
 #include <filesystem>
 #include <numeric>
 #include <print>
@@ -26,6 +30,7 @@
 #include <utility>
 
 #include <cmath>
+#include <cstdint>
 #include <cstdlib>
 
 constexpr auto application_name = std::string_view{"C++Live example"};
@@ -34,6 +39,8 @@ namespace demo
 {
     USING_W_GLSW
 
+    inline constexpr auto options = shader_options{.uses_iDate = false};
+
     inline auto mainImage(vec2 fragCoord)
     {
         auto const uv = (fragCoord - 0.5 * iResolution.xy()) / iResolution.y * 3;
@@ -45,12 +52,13 @@ namespace demo
 
 auto const my_shaders = std::array
 {
-    std::pair{&demo::mainImage, "Demo"},
-    // std::pair{&wood_shader_toy::mainImage, "Toy"},
-    std::pair{&heat_dissipation::mainImage, "Heat"},
-    std::pair{&flying_spiral::mainImage, "Spiral"},
-    std::pair{&smooth_sine::mainImage, "Sine"},
-    std::pair{&what_is_ray_marching::mainImage, "Raymarching"}
+    W_GLSL_SHADER_AS(demo, "Demo"),
+    // W_GLSL_SHADER_AS(wood_shader_toy, "Toy"),
+    W_GLSL_SHADER_AS(heat_dissipation, "Heat"),
+    W_GLSL_SHADER_AS(flying_spiral, "Spiral"),
+    W_GLSL_SHADER_AS(smooth_sine, "Sine"),
+    W_GLSL_SHADER_AS(mandelbrot, "Mandelbrot"),
+    W_GLSL_SHADER_AS(what_is_ray_marching, "Raymarching")
 #if defined(CPP_LIVE_HAVE_MORE_SHADERS)
     CPP_LIVE_HAVE_MORE_SHADERS
 #endif
@@ -68,18 +76,22 @@ try
 
         auto mouse = w::glsw::POINT{};
 
-        auto window = []
+        auto profiler = w::glsw::profiler{size(my_shaders)};
+
+        auto step_budget = 0u; // ray marching steps per pixel and frame, 0 for no limit
+
+        auto const title = std::string{application_name} + " [" + w::get_variant_str() + "]";
+
+        auto window = [&]
         {
             auto const W = 300;
             auto const H = 200;
             auto const X = ::GetSystemMetrics(SM_CXSCREEN) - W;
             auto const Y = ::GetSystemMetrics(SM_CYSCREEN) - H;
 
-            auto const v = w::get_variant_str();
-
             return w::windows::basic_window
             {
-                std::string{application_name} + " [" + v + "]",
+                title,
                 {X, Y, X + W, Y + H},
                 WS_EX_TOPMOST | WS_EX_NOACTIVATE,
                 WS_OVERLAPPED | WS_CAPTION | WS_SYSMENU
@@ -90,19 +102,22 @@ try
 
         auto load_to_ichannel = [](w::windows::wic::factory & l, w::glsw::sampler2D & s, std::filesystem::path const & p, w::windows::gdi::scoped_dc const & sdc)
         {
-            auto const picture = l.load(p, sdc);
-            auto [width, height] = picture.size();
-            auto const src = picture.dib.ptr();
-            auto const cnt = width * height;
-            s.data.resize(cnt);
-            std::copy(src, src + cnt, s.data.data());
-            s.width = width;
-            s.height = height;
+            // Decoded textures are cached under output/, so relaunches after an edit just map them.
+            w::glsw::load_cached
+            (
+                s, p, "output", w::glsw::texel_layout::blocks,
+                [&](w::glsw::sampler2D & s, auto, w::glsw::texel_layout layout)
+                {
+                    auto const picture = l.load(p, sdc);
+                    auto [width, height] = picture.size();
+                    s.assign(width, height, picture.dib.ptr(), width, layout);
+                }
+            );
         };
         
         {
             auto sdc = window.dc();
-            // load_to_ichannel(loader, w::glsw::iChannel0, R"path(THE-IMAGE.png)path", sdc);
+            // load_to_ichannel(loader, w::glsw::channel_textures[0], R"path(THE-IMAGE.png)path", sdc);
         }
 
         window.on_paint = [&](w::windows::gdi::image & output)
@@ -126,37 +141,77 @@ try
     #endif
             auto const whole_window = size(v) == 1;
 
-            unsigned i = -1;
-            for (auto f : v)
+            auto const time = std::chrono::duration_cast<std::chrono::nanoseconds>(w::now() - started_at).count() / 1e9f;
+
+            // All the ray marching shaders of the grid draw on one budget.
+            if (step_budget)
+            {
+                auto const cells  = std::min(size(v), std::size_t(n * (height / w)));
+                auto const pixels = whole_window ? std::int64_t(width) * height : std::int64_t(cells) * w * w;
+                w::glsw::raymarch::step_budget.reset(step_budget * pixels);
+            }
+            else
             {
-                ++i;
-                auto const x = LONG(i % n * w);
-                auto const y = whole_window ? 0 : height - LONG((i / n + 1) * w);
+                w::glsw::raymarch::step_budget.reset();
+            }
 
-                if (x + w > width || y < 0)
+            // Each render binds its own uniforms, so the whole grid shares the thread pool.
+            // duration stays indexed like the shaders, cells that don't fit keep an empty name.
+            duration.assign(size(v), {});
+            auto const indices = std::views::iota(std::size_t{}, size(v));
+            std::for_each
+            (
+                std::execution::par,
+                indices.begin(), indices.end(),
+                [&](auto i)
                 {
-                    continue;
-                }
+                    auto const & f = v[i];
+                    auto const x = LONG(i % n * w);
+                    auto const y = whole_window ? 0 : height - LONG((i / n + 1) * w);
 
-                auto const s = whole_window ? w::glsw::SIZE{width, height} : w::glsw::SIZE{w, w};
+                    if (x + w > width || y < 0)
+                    {
+                        return;
+                    }
 
-                auto const b = w::now();
-                auto const time = std::chrono::duration_cast<std::chrono::nanoseconds>(b - started_at).count() / 1e9f;
-                w::glsw::render(time, {x, y}, s, f.first, output, mouse);
-                auto const e = w::now();
+                    auto const s = whole_window ? w::glsw::SIZE{width, height} : w::glsw::SIZE{w, w};
 
-                if (first_frame)
-                {
-                    duration.emplace_back(f.second, e - b);
+                    // The grid shares the pool, so the wall time of one render also counts
+                    // the shaders beside it. What a shader costs is the time its own tiles
+                    // kept a worker busy, each tile runs on one worker from start to end.
+                    auto tiles = w::glsw::tile_profile{};
+                    auto options = w::glsw::render_options{};
+                    options.srgb = f.options.srgb;
+                    options.profile = &tiles;
+
+                    w::glsw::render(w::glsw::make_uniforms(time, {x, y}, s, mouse, f.options), {x, y}, s, f, output, options);
+                    auto const busy = std::accumulate(tiles.times.begin(), tiles.times.end(), std::chrono::nanoseconds{});
+
+                    duration[i] = {f.name, busy};
+
+                    if (profiler.enabled())
+                    {
+                        profiler.record(i, busy, std::move(tiles));
+                        auto const [history, last] = profiler.get(i);
+                        w::glsw::draw_profile({x, y}, last, history, output);
+                    }
                 }
+            );
+
+            if (profiler.enabled() && !duration.empty())
+            {
+                auto const slowest = std::size_t(std::ranges::max_element(duration, {}, [](auto const & d) { return d.second; }) - begin(duration));
+                window.set_title(title + " " + duration[slowest].first + " " + profiler.summary(slowest));
             }
 
             if (first_frame)
             {
-                auto const total_time = std::accumulate(begin(duration), end(duration), std::chrono::nanoseconds{}, [](auto a, auto b) { return a + b.second; });
+                auto shaded = duration;
+                std::erase_if(shaded, [](auto const & d) { return d.first.empty(); });
+                auto const total_time = std::accumulate(begin(shaded), end(shaded), std::chrono::nanoseconds{}, [](auto a, auto b) { return a + b.second; });
     #if 0
                 unsigned i = 1;
-                for (auto [n, d] : duration)
+                for (auto [n, d] : shaded)
                 {
                     auto const m = total_time.count() ? 100. * d.count() / total_time.count() : 100;
                     std::println("{:>3}. {:<30} {:>15} {:>10.1f}%", i, n, d, m);
@@ -169,6 +224,28 @@ try
                 first_frame = false;
             }
         };
+        // Ctrl+Alt+P toggles the profiler: tile heat map and frame time histogram over every
+        // shader, percentiles of the slowest one in the title. Ctrl+Alt+B cycles the steps
+        // ray marching shaders get through no limit, 32, 16 and 8 per pixel, see
+        // raymarch::budget. Without a hot key, held by another program, its setting just
+        // stays off.
+        window.register_hotkey(1, MOD_CONTROL | MOD_ALT, 'P');
+        window.register_hotkey(2, MOD_CONTROL | MOD_ALT, 'B');
+        window.on_hotkey = [&](int id)
+        {
+            if (id == 1)
+            {
+                profiler.toggle();
+                if (!profiler.enabled())
+                {
+                    window.set_title(title);
+                }
+            }
+            else if (id == 2)
+            {
+                step_budget = step_budget == 0 ? 32 : step_budget > 8 ? step_budget / 2 : 0;
+            }
+        };
         window.on_mouse_move = [&](auto x, auto y)
         {
             auto const [width, height] = window.client_size();
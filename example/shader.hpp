@@ -1,6 +1,8 @@
 #pragma once
 
 #include <w/glsw.hpp>
+#include <w/glsw/pipeline.hpp>
+#include <w/glsw/raymarch.hpp>
 #include <w/math/lemniscate.hpp>
 
 // https://www.shadertoy.com/view/ldscDM
@@ -8,6 +10,8 @@ namespace wood_shader_toy
 {
     USING_W_GLSW
 
+    inline constexpr auto options = shader_options{.uses_iDate = false};
+
     /*--------------------------------------------------------------------------------------
     License CC0 - http://creativecommons.org/publicdomain/zero/1.0/
     To the extent possible under law, the author(s) have dedicated all copyright and related and neighboring rights to this software to the public domain worldwide. This software is distributed without any warranty.
@@ -17,26 +21,17 @@ namespace wood_shader_toy
     */
 
     // ---------------- Config ----------------
-    // This is an option that lets you render high quality frames for screenshots. It enables
-    // stochastic antialiasing and motion blur automatically for any shader.
-    auto const NON_REALTIME_HQ_RENDER = false;
-    const float frameToRenderHQ = 22.0; // Time in seconds of frame to render
-    const float antialiasingSamples = 16.0; // 16x antialiasing - too much might make the shader compiler angry.
-
     auto const MANUAL_CAMERA = false;
 
-    // --------------------------------------------------------
-    // These variables are for the non-realtime block renderer.
-
     // Animation variables
     
     float const exposure = 1.0;
 
     // lighting vars
-    const vec3 sunCol = vec3(250.0, 220.0, 200.0) / 3555.0;
-    const vec3 horizonCol = vec3(0.95, 0.95, 0.95)*1.3;
-    const vec3 skyCol = vec3(0.13,0.28,0.95);
-    const vec3 groundCol = vec3(0.003,0.7,0.75);
+    constexpr vec3 sunCol = vec3(250.0, 220.0, 200.0) / 3555.0;
+    constexpr vec3 horizonCol = vec3(0.95, 0.95, 0.95)*1.3;
+    constexpr vec3 skyCol = vec3(0.13,0.28,0.95);
+    constexpr vec3 groundCol = vec3(0.003,0.7,0.75);
 
     // ---- noise functions ----
     inline float v31(vec3 a)
@@ -350,23 +345,25 @@ namespace wood_shader_toy
         vec3 pos = vec3(0.0);
         const float smallVal = 0.000625;
         // ray marching time
-        for (int i = 250; i >= 0; i--)	// This is the count of the max times the ray actually marches.
-        {
-            // Step along the ray.
-            pos = (camPos + rayVec * t);
-            // This is _the_ function that defines the "distance field".
-            // It's really what makes the scene geometry. The idea is that the
-            // distance field returns the distance to the closest object, and then
-            // we know we are safe to "march" along the ray by that much distance
-            // without hitting anything. We repeat this until we get really close
-            // and then break because we have effectively hit the object.
-            distAndMat = DistanceToObject(pos, poofCycle, poofPos);
-
-            // move down the ray a safe amount
-            t += distAndMat.x;
-            // If we are very close to the object, let's call it a hit and exit this loop.
-            if ((t > maxDepth) || (abs(distAndMat.x) < smallVal)) break;
-        }
+        // DistanceToObject is _the_ function that defines the "distance field".
+        // It's really what makes the scene geometry. The idea is that the
+        // distance field returns the distance to the closest object, and then
+        // we know we are safe to "march" along the ray by that much distance
+        // without hitting anything. We repeat this until we get really close
+        // and then break because we have effectively hit the object.
+        // Primary rays all leave the camera, so each one starts where its
+        // neighbour proved the scene empty.
+        thread_local auto primary = raymarch::coherence{};
+        auto const hit = raymarch::march
+        (
+            camPos, rayVec,
+            [&](vec3 p) { return DistanceToObject(p, poofCycle, poofPos); },
+            {.steps = 251, .epsilon = smallVal, .far = maxDepth, .relaxation = 1.2f},
+            &primary
+        );
+        t = hit.t;
+        distAndMat = hit.value;
+        pos = camPos + rayVec * t;
 
         // --------------------------------------------------------------------------------
         // Now that we have done our ray marching, let's put some color on this geometry.
@@ -451,18 +448,25 @@ namespace wood_shader_toy
         return finalColor;
     }
 
-    // Input is UV coordinate of pixel to render.
-    // Output is RGB color.
-    inline vec3 RayTrace(vec2 fragCoord, float const localTime, float & fade, float & poofCycle, vec3 & poofPos, vec3 const sunDir)
+    // The camera and the animation, which only depend on the time.
+    struct frame
     {
-        fade = 1.0;
+        float localTime;
+        float poofCycle;
+        vec3 poofPos;
+        vec3 camPos;
+        vec3 camVec;
+        vec3 sideNorm;
+        vec3 upNorm;
+    };
+
+    inline auto prepare()
+    {
+        frame f;
+        f.localTime = iTime;
 
         vec3 camPos, camUp, camLookat;
         // ------------------- Set up the camera rays for ray marching --------------------
-        // Map uv to [-1.0..1.0]
-        vec2 uv = fragCoord/iResolution.xy() * 2.0 - 1.0;
-        uv /= 3.0;  // zoom in
-
         if (MANUAL_CAMERA)
         {
             // Camera up vector.
@@ -479,7 +483,7 @@ namespace wood_shader_toy
         else
         {
             // Repeat the animation after time t3
-            float time = localTime *0.25;
+            float time = f.localTime *0.25;
             camPos = vec3(0.0, 0.4, 8.0);
             camPos.x = sin(time)*7.0;
             camPos.y += (-cos(time*2.0)+1.0)*4.0;
@@ -489,21 +493,33 @@ namespace wood_shader_toy
         }
 
         // ---- animation ----
-        poofCycle = fract(localTime*0.25);
-        poofPos = -vec3(0.6 - poofCycle*poofCycle*12.0, poofCycle * 4.0 + 0.5, 0.0);
+        f.poofCycle = fract(f.localTime*0.25);
+        f.poofPos = -vec3(0.6 - f.poofCycle*f.poofCycle*12.0, f.poofCycle * 4.0 + 0.5, 0.0);
 
         // Camera setup for ray tracing / marching
-        vec3 camVec=normalize(camLookat - camPos);
-        vec3 sideNorm=normalize(cross(camUp, camVec));
-        vec3 upNorm=cross(camVec, sideNorm);
-        vec3 worldFacing=(camPos + camVec);
-        vec3 worldPix = worldFacing + uv.x * sideNorm * (iResolution.x/iResolution.y) + uv.y * upNorm;
-        vec3 rayVec = normalize(worldPix - camPos);
+        f.camPos = camPos;
+        f.camVec=normalize(camLookat - camPos);
+        f.sideNorm=normalize(cross(camUp, f.camVec));
+        f.upNorm=cross(f.camVec, f.sideNorm);
+        return f;
+    }
+
+    // Input is UV coordinate of pixel to render.
+    // Output is RGB color.
+    inline vec3 RayTrace(frame const & f, vec2 fragCoord, vec3 const sunDir)
+    {
+        // Map uv to [-1.0..1.0]
+        vec2 uv = fragCoord/iResolution.xy() * 2.0 - 1.0;
+        uv /= 3.0;  // zoom in
+
+        vec3 worldFacing=(f.camPos + f.camVec);
+        vec3 worldPix = worldFacing + uv.x * f.sideNorm * (iResolution.x/iResolution.y) + uv.y * f.upNorm;
+        vec3 rayVec = normalize(worldPix - f.camPos);
 
         vec3 normal;
         vec2 distAndMat;
         float t;
-        vec3 finalColor = TraceOneRay(camPos, rayVec, normal, distAndMat, t, localTime, poofCycle, poofPos, sunDir);
+        vec3 finalColor = TraceOneRay(f.camPos, rayVec, normal, distAndMat, t, f.localTime, f.poofCycle, f.poofPos, sunDir);
 
         // vignette?
         finalColor *= vec3(1.0) * saturate(1.0 - length(uv/2.5));
@@ -513,83 +529,15 @@ namespace wood_shader_toy
         return vec3(clamp(finalColor, 0.0, 1.0));
     }
 
-    // This function breaks the image down into blocks and scans
-    // through them, rendering 1 block at a time. It's for non-
-    // realtime things that take a long time to render.
-
-    // This is the frame rate to render at. Too fast and you will
-    // miss some blocks.
-    const float blockRate = 20.0;
-    inline void BlockRender(vec2 fragCoord)
-    {
-        // blockSize is how much it will try to render in 1 frame.
-        // adjust this smaller for more complex scenes, bigger for
-        // faster render times.
-        const float blockSize = 64.0;
-        // Make the block repeatedly scan across the image based on time.
-        float frame = floor(iTime * blockRate);
-        vec2 blockRes = floor(iResolution.xy() / blockSize) + vec2(1.0);
-        // ugly bug with mod.
-        //float blockX = mod(frame, blockRes.x);
-        float blockX = fract(frame / blockRes.x) * blockRes.x;
-        //float blockY = mod(floor(frame / blockRes.x), blockRes.y);
-        float blockY = fract(floor(frame / blockRes.x) / blockRes.y) * blockRes.y;
-        // Don't draw anything outside the current block.
-        if ((fragCoord.x - blockX * blockSize >= blockSize) ||
-            (fragCoord.x - (blockX - 1.0) * blockSize < blockSize) ||
-            (fragCoord.y - blockY * blockSize >= blockSize) ||
-            (fragCoord.y - (blockY - 1.0) * blockSize < blockSize))
-        {
-            // TODO: discard;
-        }
-    }
-
-    inline auto mainImage(vec2 fragCoord)
+    inline auto mainImage(frame const & f, vec2 fragCoord)
     {
-        float fade = 1.0;
-        float seed = 1.0;
         vec4 fragColor;
-        if (NON_REALTIME_HQ_RENDER)
-        {
-            // Optionally render a non-realtime scene with high quality
-            BlockRender(fragCoord);
-        }
 
-        // Do a multi-pass render
+        // Antialiasing and motion blur for stills come from the host, which accumulates
+        // jittered samples with w::glsw::accumulator.
         vec3 finalColor = vec3(0.0);
-        float localTime = iTime;
-        float poofCycle = 0.0;
-        vec3 poofPos = vec3(0.0);
-        vec3 sunDir = normalize(vec3(0.93, 1.0, 1.0));
-    if (NON_REALTIME_HQ_RENDER)
-    {
-        for (float i = 0.0; i < antialiasingSamples; i++)
-        {
-            const float motionBlurLengthInSeconds = 1.0 / 60.0;
-            // Set this to the time in seconds of the frame to render.
-            localTime = frameToRenderHQ;
-            // This line will motion-blur the renders
-            localTime += Hash11(v21(fragCoord + seed)) * motionBlurLengthInSeconds;
-            // Jitter the pixel position so we get antialiasing when we do multiple passes.
-            vec2 jittered = fragCoord + vec2(
-                Hash21(fragCoord + seed),
-                Hash21(fragCoord*7.234567 + seed)
-                );
-            // don't antialias if only 1 sample.
-            if (antialiasingSamples == 1.0) jittered = fragCoord;
-            // Accumulate one pass of raytracing into our pixel value
-            finalColor += RayTrace(jittered, localTime, fade, poofCycle, poofPos, sunDir);
-            // Change the random seed for each pass.
-            seed *= 1.01234567;
-        }
-        // Average all accumulated pixel intensities
-        finalColor /= antialiasingSamples;
-    }
-    else
-    {
-        // Regular real-time rendering
-        finalColor = RayTrace(fragCoord, localTime, fade, poofCycle, poofPos, sunDir);
-    }
+        constexpr vec3 sunDir = normalize(vec3(0.93, 1.0, 1.0));
+        finalColor = RayTrace(f, fragCoord, sunDir);
 
         fragColor = vec4(sqrt(clamp(finalColor, 0.0, 1.0)),1.0);
 
@@ -599,8 +547,10 @@ namespace wood_shader_toy
 
 namespace heat_dissipation
 {
-    USING_W_GLSW
-    
+    USING_W_GLSW_AS(fast)
+
+    inline constexpr auto options = shader_options{.uses_iDate = false};
+
     // Animated Heat Dissipation Shader
     // Author: o3-mini
     // Description: A simple animated heat dissipation simulation using moving
@@ -612,7 +562,26 @@ namespace heat_dissipation
         return sin(p.x)*cos(p.y);
     }
 
-    inline auto mainImage(vec2 fragCoord)
+    const int numSpots = 30;
+
+    struct frame
+    {
+        std::array<vec2, numSpots> spots;
+    };
+
+    inline auto prepare()
+    {
+        frame f;
+        for (int i = 0; i < numSpots; i++) {
+            // Compute a moving position for each spot. They orbit around the center.
+            // Offset each by a phase shift based on the loop index.
+            float phase = iTime + float(i) * 2.0;
+            f.spots[i] = vec2(sin(phase), cos(phase)) * 0.5;
+        }
+        return f;
+    }
+
+    inline auto mainImage(frame const & f, vec2 fragCoord)
     {
         // Normalize pixel coordinates (0 to 1)
         vec2 uv = fragCoord / iResolution.xy();
@@ -623,18 +592,14 @@ namespace heat_dissipation
         
         // We'll sum contributions from several Gaussian "heat" spots.
         float heat = 0.0;
-        const int numSpots = 30;
-        for (int i = 0; i < numSpots; i++) {
-            // Compute a moving position for each spot. They orbit around the center.
-            // Offset each by a phase shift based on the loop index.
-            float phase = iTime + float(i) * 2.0;
-            vec2 pos = vec2(sin(phase), cos(phase)) * 0.5;
-            
-            // Calculate the distance from the current pixel to the moving spot.
-            float d = length(uv - pos);
+        for (vec2 pos : f.spots) {
+            // Calculate the offset from the current pixel to the moving spot.
+            vec2 d = uv - pos;
             
             // Contribution decreases with square of the distance; factor controls spread.
-            heat += exp(-d * d * 20.0);
+            // dot(d, d) rather than squaring length(d) leaves out the square root, which
+            // lets the compiler vectorize this loop.
+            heat += exp(-dot(d, d) * 20.0);
         }
         
         // Modulate heat with a simple noise function for extra animated effect.
@@ -653,21 +618,63 @@ namespace heat_dissipation
         // Optionally, apply a gamma correction or other post-processing as needed.
         return vec4(col, 0.f);
     }
+
+    // The same for a packet of fragments, one per lane.
+    inline auto noise(simd::vec2 p)
+    {
+        return sin(p.x) * cos(p.y);
+    }
+
+    inline auto mainImage(frame const & f, simd::vec2 fragCoord)
+    {
+        simd::vec2 uv = fragCoord / simd::vec2(iResolution.xy());
+        uv = uv * 2.0 - 1.0;
+        uv.x *= iResolution.x / iResolution.y;
+
+        simd::lanes heat = 0.0;
+        for (vec2 pos : f.spots) {
+            simd::vec2 d = uv - simd::vec2(pos);
+            heat += exp(-dot(d, d) * 20.0);
+        }
+
+        simd::lanes n = noise(uv * 10.0 + iTime);
+        heat *= 0.5 + 0.5 * n;
+
+        simd::vec3 col = simd::vec3(
+            pow(heat, 1.2),
+            heat * 0.7,
+            heat * 0.2
+        );
+        return simd::vec4(col, 0.f);
+    }
 }
 
 namespace flying_spiral
 {
     USING_W_GLSW
 
-    inline auto mainImage(vec2 fragCoord)
+    inline constexpr auto options = shader_options{.uses_iDate = false};
+
+    struct frame
+    {
+        vec2 centre;
+        float spin;
+    };
+
+    inline auto prepare()
+    {
+        auto [lx, ly] = w::math::lemniscate(iTime / 10.f);
+        return frame{vec2(lx, ly) / 2.f, iTime * 3};
+    }
+
+    inline auto mainImage(frame const & f, vec2 fragCoord)
     {
         vec2 uv = fragCoord/iResolution.xy() - 0.5;
         uv.x *= iResolution.x / iResolution.y;
 
-        auto [lx, ly] = w::math::lemniscate(iTime / 10.f);
-        uv = uv + vec2(lx, ly) / 2.f;
+        uv = uv + f.centre;
 
-        float a = length(uv) * 30 + iTime * 3;
+        float a = length(uv) * 30 + f.spin;
         mat2 m = mat2(cos(a), -sin(a), sin(a), cos(a));
         vec2 t = m * uv;
 
@@ -679,25 +686,69 @@ namespace smooth_sine
 {
     USING_W_GLSW
 
-    inline auto mainImage(vec2 fragCoord)
+    inline constexpr auto options = shader_options{.uses_iDate = false};
+
+    struct frame
     {
-        vec2 uv = fragCoord / iResolution.xy() - .5;
+        float phase;
+        vec3 below;
+        vec3 above;
+    };
 
-        vec3 col = vec3(step(uv.y, sin(uv.x * 10.f + iTime * 3.f) / 7.f));
+    inline auto prepare()
+    {
         vec3 a = vec3(1., 1., 1.);
         vec3 b = vec3(0., 0., 0.);
         float t = abs(sin(iTime / 5.));
-        col = mix(mix(a, b, t), mix(b, a, t), col.x);
+        return frame{iTime * 3.f, mix(a, b, t), mix(b, a, t)};
+    }
+
+    inline auto mainImage(frame const & f, vec2 fragCoord)
+    {
+        vec2 uv = fragCoord / iResolution.xy() - .5;
+
+        vec3 col = vec3(step(uv.y, sin(uv.x * 10.f + f.phase) / 7.f));
+        col = mix(f.below, f.above, col.x);
         
         return vec4(col, 1.f);
     }
 }
 
 // https://www.youtube.com/watch?v=TSAIR03FPfY
+namespace mandelbrot
+{
+    USING_W_GLSW
+
+    // The same image every frame, a host rendering on demand shades it again only when the
+    // window or the shader changes.
+    inline constexpr auto options = shader_options{.uses_iDate = false, .uses_iTime = false};
+
+    inline auto mainImage(vec2 fragCoord)
+    {
+        vec2 c = (fragCoord - 0.5 * iResolution.xy()) / iResolution.y * 2.5 - vec2(0.75, 0.0);
+        vec2 z = vec2(0.0);
+        float n = 0.0;
+        for (int i = 0; i < 256 && dot(z, z) < 16.0; i++) {
+            z = vec2(z.x * z.x - z.y * z.y, 2.0 * z.x * z.y) + c;
+            n += 1.0;
+        }
+        if (n == 256.0) {
+            return vec4(0.0, 0.0, 0.0, 1.0);
+        }
+
+        // Smooth iteration count, so that the bands blend instead of stepping.
+        float s = n - log(log(dot(z, z)) / log(2.0)) / log(2.0);
+        vec3 col = 0.5 + 0.5 * cos(3.0 + s * 0.15 + vec3(0.0, 0.6, 1.0));
+        return vec4(col, 1.0);
+    }
+}
+
 namespace what_is_ray_marching
 {
     USING_W_GLSW
 
+    inline constexpr auto options = shader_options{.uses_iDate = false, .srgb = true};
+
     float const NUM_OF_STEPS = 128;
     float const MIN_DIST_TO_SDF = 0.001;
     float const MAX_DIST_TO_TRAVEL = 64;
@@ -718,12 +769,20 @@ namespace what_is_ray_marching
         return mix(d2, d1, h) - k * h * (1.f - h);
     }
 
-    inline float map(vec3 p)
+    struct frame
     {
-        float radius = 0.5;
-        vec3 center = vec3(0.);
+        vec3 center;
+    };
 
-        center = vec3(0.f, -0.25f + sin(iTime) * .5f, 0.f);
+    inline auto prepare()
+    {
+        return frame{vec3(0.f, -0.25f + sin(iTime) * .5f, 0.f)};
+    }
+
+    inline float map(frame const & f, vec3 p)
+    {
+        float radius = 0.5;
+        vec3 center = f.center;
 
         float sphere = sdfSphere(p, center, radius);
         float m = sphere;
@@ -738,36 +797,20 @@ namespace what_is_ray_marching
         return m;
     }
 
-    inline float rayMarch(vec3 ro, vec3 rd, float maxDistToTravel)
+    // rd isn't normalized, so steps overshoot by its length and the field isn't a bound
+    // along it. That is part of the image: plain steps, no coherence, inside counts as a hit.
+    inline float rayMarch(frame const & f, vec3 ro, vec3 rd, float maxDistToTravel)
     {
-        float dist = 0.;
-        for (float i = 0.; i < NUM_OF_STEPS; ++i)
-        {
-            vec3 currentPos = ro + rd * dist;
-            float distToSdf = map(currentPos);
-
-            if (distToSdf < MIN_DIST_TO_SDF)
-            {
-                break;
-            }
-
-            dist += distToSdf;
-
-            if (dist > maxDistToTravel)
-            {
-                break;
-            }
-        }
-
-        return dist;
+        auto const s = raymarch::settings{.steps = int(NUM_OF_STEPS), .epsilon = MIN_DIST_TO_SDF, .far = maxDistToTravel, .inside = true};
+        return raymarch::march(ro, rd, [&](vec3 p) { return map(f, p); }, s).t;
     }
 
-    inline vec3 getNormal(vec3 p)
+    inline vec3 getNormal(frame const & f, vec3 p)
     {
         vec2 d = vec2(0.01, 0.);
-        float gx = map(p + d.xyy()) - map(p - d.xyy());
-        float gy = map(p + d.yxy()) - map(p - d.yxy());
-        float gz = map(p + d.yyx()) - map(p - d.yyx());
+        float gx = map(f, p + d.xyy()) - map(f, p - d.xyy());
+        float gy = map(f, p + d.yxy()) - map(f, p - d.yxy());
+        float gz = map(f, p + d.yyx()) - map(f, p - d.yyx());
         vec3 normal = vec3(gx, gy, gz);
         return normalize(normal);
     }
@@ -783,26 +826,27 @@ namespace what_is_ray_marching
         );
     }
 
-    inline vec3 render(vec2 uv)
+    inline vec3 render(frame const & f, vec2 uv)
     {
         vec3 color = vec3(0.f);
 
         vec3 ro = vec3(0.f, 0.f, -3.f);
         vec3 rd = vec3(uv, 1.f);
 
-        float dist = rayMarch(ro, rd, MAX_DIST_TO_TRAVEL);
+        float dist = rayMarch(f, ro, rd, MAX_DIST_TO_TRAVEL);
 
         if (dist < MAX_DIST_TO_TRAVEL)
         {
             color = vec3(1.);
 
             vec3 p = ro + rd * dist;
-            vec3 normal = getNormal(p);
+            vec3 normal = getNormal(f, p);
             color = normal;
 
             vec3 lightColor = vec3(1.);
-            vec3 lightSource = vec3(2.5, 2.5, -1.0);
-            float diffuseStrength = max(0.f, dot(normalize(lightSource), normal));
+            constexpr vec3 lightSource = vec3(2.5, 2.5, -1.0);
+            constexpr vec3 lightDirection = normalize(lightSource);
+            float diffuseStrength = max(0.f, dot(lightDirection, normal));
             vec3 diffuse = lightColor * diffuseStrength;
 
             vec3 viewSource = normalize(ro);
@@ -814,26 +858,161 @@ namespace what_is_ray_marching
             vec3 lighting = diffuse * 0.75f + specular * 0.25;
             color = lighting;
 
-            vec3 lightDirection = normalize(lightSource);
             float distToLightSource = length(lightSource - p);
             ro = p + normal * 0.1f;
             rd = lightDirection;
-            float dist = rayMarch(ro, rd, distToLightSource);
+            float dist = rayMarch(f, ro, rd, distToLightSource);
             if (dist < distToLightSource)
             {
                 color = color * vec3(0.25);
             }
         }
 
-        return pow(color, vec3(1. / 2.2));
+        return color; // linear, options.srgb has it encoded on output
     }
 
-    inline auto mainImage(vec2 fragCoord)
+    inline auto mainImage(frame const & f, vec2 fragCoord)
     {
         vec2 UV = fragCoord - iResolution.xy()*0.5;
         UV /= iResolution.y;
 
-        vec3 color = render(UV);
+        vec3 color = render(f, UV);
         return vec4(color, 1.0);
     }
+
+    // The same for a packet of fragments, one per lane. Their rays march together, a lane
+    // that is done waits under a mask for the others, and the branches on hit and shadow
+    // become selects.
+    inline auto sdfPlane(simd::vec3 p, vec3 n, float h)
+    {
+        return dot(p, simd::vec3(n)) + h;
+    }
+
+    inline auto sdfSphere(simd::vec3 p, vec3 c, float r)
+    {
+        return length(p - simd::vec3(c)) - r;
+    }
+
+    inline auto opSmoothUnion(simd::lanes d1, simd::lanes d2, float k)
+    {
+        simd::lanes h = clamp(0.5f + 0.5f * (d2 - d1) / k, 0.f, 1.0f);
+        return mix(d2, d1, h) - k * h * (1.f - h);
+    }
+
+    inline auto map(frame const & f, simd::vec3 p)
+    {
+        simd::lanes sphere = sdfSphere(p, f.center, 0.5);
+        simd::lanes plane = sdfPlane(p, vec3(0., 1., 0.), 1.);
+        return opSmoothUnion(sphere, plane, 0.5);
+    }
+
+    inline auto rayMarch(frame const & f, simd::vec3 ro, simd::vec3 rd, simd::lanes maxDistToTravel, simd::mask rays)
+    {
+        auto const s = raymarch::settings{.steps = int(NUM_OF_STEPS), .epsilon = MIN_DIST_TO_SDF, .inside = true};
+        return raymarch::march(ro, rd, [&](simd::vec3 p) { return map(f, p); }, s, maxDistToTravel, rays).t;
+    }
+
+    inline auto getNormal(frame const & f, simd::vec3 p)
+    {
+        vec2 d = vec2(0.01, 0.);
+        simd::lanes gx = map(f, p + simd::vec3(d.xyy())) - map(f, p - simd::vec3(d.xyy()));
+        simd::lanes gy = map(f, p + simd::vec3(d.yxy())) - map(f, p - simd::vec3(d.yxy()));
+        simd::lanes gz = map(f, p + simd::vec3(d.yyx())) - map(f, p - simd::vec3(d.yyx()));
+        return normalize(simd::vec3(gx, gy, gz));
+    }
+
+    inline auto render(frame const & f, simd::vec2 uv)
+    {
+        simd::vec3 color = simd::vec3(0.f);
+
+        vec3 ro = vec3(0.f, 0.f, -3.f);
+        simd::vec3 rd = simd::vec3(uv, 1.f);
+
+        simd::lanes dist = rayMarch(f, simd::vec3(ro), rd, MAX_DIST_TO_TRAVEL, !simd::mask{});
+        simd::mask hit = dist < MAX_DIST_TO_TRAVEL;
+
+        if (any(hit))
+        {
+            simd::vec3 p = simd::vec3(ro) + rd * dist;
+            simd::vec3 normal = getNormal(f, p);
+
+            vec3 lightColor = vec3(1.);
+            constexpr vec3 lightSource = vec3(2.5, 2.5, -1.0);
+            constexpr vec3 lightDirection = normalize(lightSource);
+            simd::lanes diffuseStrength = max(0.f, dot(simd::vec3(lightDirection), normal));
+            simd::vec3 diffuse = simd::vec3(lightColor) * diffuseStrength;
+
+            vec3 viewSource = normalize(ro);
+            simd::vec3 reflectSource = normalize(reflect(simd::vec3(-lightSource), normal));
+            simd::lanes specularStrength = max(0.f, dot(simd::vec3(viewSource), reflectSource));
+            specularStrength = pow(specularStrength, 64.f);
+            simd::vec3 specular = specularStrength * simd::vec3(lightColor);
+
+            simd::vec3 lighting = diffuse * 0.75f + specular * 0.25;
+
+            simd::lanes distToLightSource = length(simd::vec3(lightSource) - p);
+            simd::lanes dist = rayMarch(f, p + normal * 0.1f, simd::vec3(lightDirection), distToLightSource, hit);
+            simd::mask shadow = dist < distToLightSource;
+
+            color = select(hit, select(shadow, lighting * 0.25f, lighting), color);
+        }
+
+        return color; // linear, options.srgb has it encoded on output
+    }
+
+    inline auto mainImage(frame const & f, simd::vec2 fragCoord)
+    {
+        simd::vec2 UV = fragCoord - simd::vec2(iResolution.xy()*0.5);
+        UV = UV / iResolution.y;
+
+        simd::vec3 color = render(f, UV);
+        return simd::vec4(color, 1.0);
+    }
+}
+
+// Feedback through a buffer: Buffer A fades its own last frame and draws a moving dot on
+// top, the image pass shows it.
+namespace feedback_trail
+{
+    namespace buffer_a
+    {
+        USING_W_GLSW
+
+        inline constexpr auto options = shader_options{.uses_iDate = false};
+
+        inline auto mainImage(vec2 fragCoord)
+        {
+            vec2 uv = fragCoord / iResolution.xy();
+            vec2 p = (fragCoord - 0.5 * iResolution.xy()) / iResolution.y;
+            vec2 head = vec2(cos(iTime * 1.3f), sin(iTime * 2.1f)) * 0.35f;
+            float spot = smoothstep(0.04f, 0.f, length(p - head));
+            vec3 previous = texture(iChannel0, uv);
+            return vec4(max(previous * 0.97f, vec3(1.f, 0.6f, 0.2f) * spot), 1.f);
+        }
+    }
+
+    namespace image
+    {
+        USING_W_GLSW
+
+        inline constexpr auto options = shader_options{.uses_iDate = false};
+
+        inline auto mainImage(vec2 fragCoord)
+        {
+            vec3 col = texture(iChannel0, fragCoord / iResolution.xy());
+            return vec4(col, 1.f);
+        }
+    }
+
+    inline auto make_pipeline()
+    {
+        using namespace w::glsw;
+        return pipeline
+        {
+            {
+                pass{W_GLSL_SHADER_AS(buffer_a, "Trail A"), {buffer_input(0)}},
+                pass{W_GLSL_SHADER_AS(image, "Trail"), {buffer_input(0)}}
+            }
+        };
+    }
 }
@@ -1,41 +1,84 @@
 #pragma once
 
+#include <w/glsw/simd.hpp>
+#include <w/math/approximate.hpp>
+#include <w/math/constant.hpp>
+#include <w/now.hpp>
 #include <w/operators.hpp>
+#include <w/swizzle.hpp>
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <bit>
 #include <chrono>
+#include <concepts>
 #include <execution>
+#include <memory>
 #include <stdexcept>
 #include <numbers>
 #include <ranges>
+#include <span>
+#include <tuple>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
 #include <cmath>
-
-#define USING_W_GLSW         \
-    using namespace w::glsw; \
-    using w::glsw::abs;      \
-    using w::glsw::sin;      \
-    using w::glsw::cos;      \
-    using w::glsw::tanh;     \
-    using w::glsw::atan;     \
-    using w::glsw::exp;      \
-    using w::glsw::floor;    \
-    using w::glsw::log;      \
-    using w::glsw::ceil;     \
-    using w::glsw::min;      \
-    using w::glsw::max;      \
-    using w::glsw::pow;      \
-    using w::glsw::round;    \
-    using w::glsw::sqrt;     \
+#include <cstdint>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#    include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#    include <x86intrin.h>
+#endif
+
+// Precision of sin, cos, tanh, atan, exp, log and pow: exact is libm, fast and mediump are
+// the polynomials of w/math/approximate.hpp. For every shader with -DW_GLSW_PRECISION=fast,
+// for one with USING_W_GLSW_AS(fast) in its namespace instead of USING_W_GLSW.
+#if !defined(W_GLSW_PRECISION)
+#    define W_GLSW_PRECISION exact
+#endif
+
+#define USING_W_GLSW USING_W_GLSW_AS(W_GLSW_PRECISION)
+
+#define USING_W_GLSW_AS(precision)   \
+    using namespace w::glsw;         \
+    using w::glsw::abs;              \
+    using w::glsw::precision::sin;   \
+    using w::glsw::precision::cos;   \
+    using w::glsw::precision::tanh;  \
+    using w::glsw::precision::atan;  \
+    using w::glsw::precision::exp;   \
+    using w::glsw::floor;            \
+    using w::glsw::precision::log;   \
+    using w::glsw::ceil;             \
+    using w::glsw::min;              \
+    using w::glsw::max;              \
+    using w::glsw::precision::pow;   \
+    using w::glsw::round;            \
+    using w::glsw::sqrt;             \
     /**/
 
-#define W_GLSL_SHADER(name) std::pair{&name::mainImage, #name}
+// name::options and name::prepare resolve to the shader's own declarations when it has them,
+// otherwise to w::glsw::options and w::glsw::prepare through the using-directive in
+// USING_W_GLSW.
+#define W_GLSL_SHADER_AS(name, title)                                             \
+    w::glsw::make_shader                                                          \
+    (                                                                             \
+        title, name::options,                                                     \
+        [] { return name::prepare(); },                                           \
+        [](auto const & ... a) -> decltype(name::mainImage(a...))                  \
+        {                                                                         \
+            return name::mainImage(a...);                                         \
+        }                                                                         \
+    )                                                                             \
+    /**/
+#define W_GLSL_SHADER(name) W_GLSL_SHADER_AS(name, #name)
 
 namespace w::glsw
 {
+    struct vec2;
     struct vec3;
     struct vec4;
     struct mat2;
@@ -44,51 +87,60 @@ namespace w::glsw
     struct ivec3;
     struct bvec3;
 
+    // vec2, vec3 or vec4, by the number of components.
+    template<std::size_t N>
+    using vec_of = std::tuple_element_t<N - 2, std::tuple<vec2, vec3, vec4>>;
+
+// Every swizzle GLSL has, v.zxy() to read and v.zxy(a) to write, which like assigning to
+// v.zxy returns a. Writing is a template only so that its constraint can take it away where
+// a letter repeats, as GLSL does. Declared in the vectors and defined once all three are
+// complete, since most return one of the others.
+#define W_GLSW_DECLARE_SWIZZLE(t, name, members)                                   \
+    constexpr auto name() const -> vec_of<sizeof(#name) - 1>;                      \
+    template<typename = void>                                                      \
+        requires (w::swizzle::distinct(#name))                                     \
+    constexpr auto name(vec_of<sizeof(#name) - 1> a) -> vec_of<sizeof(#name) - 1>; \
+    /**/
+#define W_GLSW_DEFINE_SWIZZLE(t, name, members)                                             \
+    inline constexpr auto t::name() const -> vec_of<sizeof(#name) - 1>                      \
+    {                                                                                       \
+        return {W_SWIZZLE_UNPACK members};                                                  \
+    }                                                                                       \
+    template<typename>                                                                      \
+        requires (w::swizzle::distinct(#name))                                              \
+    inline constexpr auto t::name(vec_of<sizeof(#name) - 1> a) -> vec_of<sizeof(#name) - 1> \
+    {                                                                                       \
+        w::swizzle::assign(a, W_SWIZZLE_UNPACK members);                                    \
+        return a;                                                                           \
+    }                                                                                       \
+    /**/
+
     struct vec2
     {
         float x;
         float y;
 
-        vec2() : x{}, y{}
+        constexpr vec2() : x{}, y{}
         {
         }
-        vec2(float i) : x{i}, y{i}
+        constexpr vec2(float i) : x{i}, y{i}
         {
         }
-        vec2(float x, float y) : x{x}, y{y}
+        constexpr vec2(float x, float y) : x{x}, y{y}
         {
         }
-        explicit vec2(vec3);
+        constexpr explicit vec2(vec3);
 
-        auto xyy() const -> vec3;
-        auto xyx() const -> vec3;
-        auto xxy() const -> vec3;
-        auto yxy() const -> vec3;
-        auto yyx() const -> vec3;
-        auto yxx() const -> vec3;
-        auto yyy() const -> vec3;
-        auto xxx() const -> vec3;
-        auto xxxx() const -> vec4;
-        auto xx() const
-        {
-            return vec2{x, x};
-        }
-        auto yx() const
-        {
-            return vec2{y, x};
-        }
-        auto yy() const
-        {
-            return vec2{y, y};
-        }
+        W_SWIZZLES(2, W_GLSW_DECLARE_SWIZZLE, vec2, x, y, , )
+        W_SWIZZLES(2, W_GLSW_DECLARE_SWIZZLE, vec2, r, g, , )
 
-        auto operator-() const
+        constexpr auto operator-() const
         {
             return vec2{-x, -y};
         }
         W_DEFINE_ARITHMETIC_ASSIGNMENT_OPERATORS(vec2, x, y)
 
-        auto operator*=(mat2 b) -> vec2 &;
+        constexpr auto operator*=(mat2 b) -> vec2 &;
 
         W_DEFINE_FRIEND_OPERATOR(vec2, +)
         W_DEFINE_FRIEND_OPERATOR(vec2, -)
@@ -100,32 +152,32 @@ namespace w::glsw
     {
         int x;
         int y;
-        ivec2() : x{}, y{}
+        constexpr ivec2() : x{}, y{}
         {
         }
-        ivec2(int a) : x{a}, y{a}
+        constexpr ivec2(int a) : x{a}, y{a}
         {
         }
-        ivec2(int x, int y) : x{x}, y{y}
+        constexpr ivec2(int x, int y) : x{x}, y{y}
         {
         }
-        explicit ivec2(vec2 a) : x{int(a.x)}, y{int(a.y)}
+        constexpr explicit ivec2(vec2 a) : x{int(a.x)}, y{int(a.y)}
         {
         }
         W_DEFINE_ARITHMETIC_ASSIGNMENT_OPERATORS(ivec2, x, y)
-        auto operator<<(std::size_t a) const
+        constexpr auto operator<<(std::size_t a) const
         {
             return ivec2{x << a, y << a};
         }
-        auto operator^(ivec2 a) const
+        constexpr auto operator^(ivec2 a) const
         {
             return ivec2{x ^ a.x, y ^ a.y};
         }
-        auto operator&(ivec2 a) const
+        constexpr auto operator&(ivec2 a) const
         {
             return ivec2{x & a.x, y & a.y};
         }
-        operator vec2() const
+        constexpr operator vec2() const
         {
             return {float(x), float(y)};
         }
@@ -143,15 +195,15 @@ namespace w::glsw
         uint x;
         uint y;
 
-        uvec2() : x{}, y{}
+        constexpr uvec2() : x{}, y{}
         {
         }
 
-        uvec2(uint x, uint y) : x{x}, y{y}
+        constexpr uvec2(uint x, uint y) : x{x}, y{y}
         {
         }
 
-        auto operator^(uvec2 right) const
+        constexpr auto operator^(uvec2 right) const
         {
             return uvec2
             {
@@ -159,7 +211,7 @@ namespace w::glsw
                 y ^ right.y
             };
         }
-        auto operator<<(uint right) const
+        constexpr auto operator<<(uint right) const
         {
             return uvec2
             {
@@ -167,7 +219,7 @@ namespace w::glsw
                 y << right
             };
         }
-        auto operator<<(uvec2 right) const
+        constexpr auto operator<<(uvec2 right) const
         {
             return uvec2
             {
@@ -175,7 +227,7 @@ namespace w::glsw
                 y << right.y
             };
         }
-        auto operator>>(uvec2 right) const
+        constexpr auto operator>>(uvec2 right) const
         {
             return uvec2
             {
@@ -191,11 +243,11 @@ namespace w::glsw
         uint y;
         uint z;
 
-        uvec3() : x{}, y{}, z{}
+        constexpr uvec3() : x{}, y{}, z{}
         {
         }
 
-        uvec3(uint x, uint y, uint z) : x{x}, y{y}, z{z}
+        constexpr uvec3(uint x, uint y, uint z) : x{x}, y{y}, z{z}
         {
         }
     };
@@ -207,59 +259,59 @@ namespace w::glsw
         uint z;
         uint w;
 
-        uvec4() : x{}, y{}, z{}, w{}
+        constexpr uvec4() : x{}, y{}, z{}, w{}
         {
         }
 
-        uvec4(uint x, uint y, uint z, uint w) : x{x}, y{y}, z{z}, w{w}
+        constexpr uvec4(uint x, uint y, uint z, uint w) : x{x}, y{y}, z{z}, w{w}
         {
         }
 
-        auto xy() const
+        constexpr auto xy() const
         {
             return uvec2{x, y};
         }
-        auto xy(uvec2 a)
+        constexpr auto xy(uvec2 a)
         {
             x = a.x;
             y = a.y;
         }
-        auto xw() const
+        constexpr auto xw() const
         {
             return uvec2{x, w};
         }
-        auto xw(uvec2 a)
+        constexpr auto xw(uvec2 a)
         {
             x = a.x;
             w = a.y;
         }
-        auto yx() const
+        constexpr auto yx() const
         {
             return uvec2{y, x};
         }
-        auto yz() const
+        constexpr auto yz() const
         {
             return uvec2{y, z};
         }
-        auto yz(uvec2 a)
+        constexpr auto yz(uvec2 a)
         {
             y = a.x;
             z = a.y;
         }
-        auto zwxy() const
+        constexpr auto zwxy() const
         {
             return uvec4{z, w, x, y};
         }
-        auto wxyz() const
+        constexpr auto wxyz() const
         {
             return uvec4{w, x, y, z};
         }
-        auto yzwx() const
+        constexpr auto yzwx() const
         {
             return uvec4{y, z, w, x};
         }
 
-        auto operator^(uvec4 right) const
+        constexpr auto operator^(uvec4 right) const
         {
             return uvec4
             {
@@ -269,11 +321,11 @@ namespace w::glsw
                 w ^ right.w
             };
         }
-        auto operator^=(uvec4 right)
+        constexpr auto operator^=(uvec4 right)
         {
             *this = *this ^ right;
         }
-        auto operator>>(uvec4 right) const
+        constexpr auto operator>>(uvec4 right) const
         {
             return uvec4
             {
@@ -284,7 +336,7 @@ namespace w::glsw
             };
         }
 
-        auto operator*(uvec4 right) const
+        constexpr auto operator*(uvec4 right) const
         {
             return uvec4
             {
@@ -294,7 +346,7 @@ namespace w::glsw
                 w * right.w
             };
         }
-        auto operator*=(uvec4 right)
+        constexpr auto operator*=(uvec4 right)
         {
             *this = *this * right;
         }
@@ -306,28 +358,28 @@ namespace w::glsw
         float y;
         float z;
 
-        vec3() : x{}, y{}, z{}
+        constexpr vec3() : x{}, y{}, z{}
         {
         }
-        vec3(float i) : x{i}, y{i}, z{i}
+        constexpr vec3(float i) : x{i}, y{i}, z{i}
         {
         }
-        vec3(float x, float y, float z) : x{x}, y{y}, z{z}
+        constexpr vec3(float x, float y, float z) : x{x}, y{y}, z{z}
         {
         }
-        vec3(vec2 a, float b) : x{a.x}, y{a.y}, z{b}
+        constexpr vec3(vec2 a, float b) : x{a.x}, y{a.y}, z{b}
         {
         }
-        vec3(float a, vec2 b) : x{a}, y{b.x}, z{b.y}
+        constexpr vec3(float a, vec2 b) : x{a}, y{b.x}, z{b.y}
         {
         }
-        vec3(vec2 a, vec3 b) : x{a.x}, y{a.y}, z{b.x}
+        constexpr vec3(vec2 a, vec3 b) : x{a.x}, y{a.y}, z{b.x}
         {
         }
-        vec3(ivec3);
-        vec3(bvec3);
+        constexpr vec3(ivec3);
+        constexpr vec3(bvec3);
 
-        vec3 & operator++()
+        constexpr vec3 & operator++()
         {
             ++x;
             ++y;
@@ -335,137 +387,18 @@ namespace w::glsw
             return *this;
         }
         
-        auto xx() const
-        {
-            return vec2{x, x};
-        }
-        auto xy() const
-        {
-            return vec2{x, y};
-        }
-        auto xy(vec2 a)
-        {
-            x = a.x;
-            y = a.y;
-        }
-        auto yx() const
-        {
-            return vec2{y, x};
-        }
-        auto yx(vec2 a)
-        {
-            y = a.x;
-            x = a.y;
-        }
-        auto yz() const
-        {
-            return vec2{y, z};
-        }
-        auto yz(vec2 a)
-        {
-            y = a.x;
-            z = a.y;
-        }
-        auto xz() const
-        {
-            return vec2{x, z};
-        }
-        auto xz(vec2 a)
-        {
-            x = a.x;
-            z = a.y;
-        }
-        auto zy() const
-        {
-            return vec2{z, y};
-        }
-        auto zy(vec2 a)
-        {
-            z = a.x;
-            y = a.y;
-        }
-        auto yy() const
-        {
-            return vec2{y, y};
-        }
-        auto xxx() const
-        {
-            return vec3{x, x, x};
-        }
-        auto xxy() const
-        {
-            return vec3{x, x, y};
-        }
-        auto xyx() const
-        {
-            return vec3{x, y, x};
-        }
-        auto xyy() const
-        {
-            return vec3{x, y, y};
-        }
-        auto xzy() const
-        {
-            return vec3{x, z, y};
-        }
-        auto xzz() const
-        {
-            return vec3{x, z, z};
-        }
-        auto xzy(vec3 a)
-        {
-            x = a.x;
-            z = a.y;
-            y = a.z;
-        }
-        auto yxx() const
-        {
-            return vec3{y, x, x};
-        }
-        auto yxy() const
-        {
-            return vec3{y, x, y};
-        }
-        auto yxz() const
-        {
-            return vec3{y, x, z};
-        }
-        auto yyx() const
-        {
-            return vec3{y, y, x};
-        }
-        auto yzx() const
-        {
-            return vec3{y, z, x};
-        }
-        auto zxy() const
-        {
-            return vec3{z, x, y};
-        }
-        auto zyx() const
-        {
-            return vec3{z, y, x};
-        }
-        auto zyz() const
-        {
-            return vec3{z, y, z};
-        }
-        auto zzz() const
-        {
-            return vec3{z, z, z};
-        }
-        auto yyxy() const -> vec4;
-        auto zzzz() const -> vec4;
+        W_SWIZZLES(3, W_GLSW_DECLARE_SWIZZLE, vec3, x, y, z, )
+        W_SWIZZLES(3, W_GLSW_DECLARE_SWIZZLE, vec3, r, g, b, )
 
-        auto operator-() const
+        constexpr auto operator-() const
         {
             return vec3{-x, -y, -z};
         }
         W_DEFINE_ARITHMETIC_ASSIGNMENT_OPERATORS(vec3, x, y, z)
 
-        auto operator*=(mat3 b) -> vec3 &;
+        constexpr auto operator*=(mat3 b) -> vec3 &;
 
-        auto operator==(vec3 const & right) const
+        constexpr auto operator==(vec3 const & right) const
         {
             return tie() == right.tie();
         }
@@ -476,7 +409,7 @@ namespace w::glsw
         W_DEFINE_FRIEND_OPERATOR(vec3, /)
     };
 
-    inline vec2::vec2(vec3 a) : x{a.x}, y{a.y}
+    inline constexpr vec2::vec2(vec3 a) : x{a.x}, y{a.y}
     {
     }
 
@@ -484,19 +417,19 @@ namespace w::glsw
     {
         int x, y, z;
 
-        ivec3() : x{}, y{}, z{}
+        constexpr ivec3() : x{}, y{}, z{}
         {
         }
 
-        ivec3(int a) : x{a}, y{a}, z{a}
+        constexpr ivec3(int a) : x{a}, y{a}, z{a}
         {
         }
 
-        ivec3(int x, int y, int z) : x{x}, y{y}, z{z}
+        constexpr ivec3(int x, int y, int z) : x{x}, y{y}, z{z}
         {
         }
 
-        explicit ivec3(vec3 a) : x{int(a.x)}, y{int(a.y)}, z{int(a.z)}
+        constexpr explicit ivec3(vec3 a) : x{int(a.x)}, y{int(a.y)}, z{int(a.z)}
         {
         }
 
@@ -513,7 +446,7 @@ namespace w::glsw
         W_DEFINE_FRIEND_OPERATOR(ivec3, ^)
     };
 
-    inline vec3::vec3(ivec3 a) : x(a.x), y(a.y), z(a.z)
+    inline constexpr vec3::vec3(ivec3 a) : x(a.x), y(a.y), z(a.z)
     {
     }
 
@@ -523,16 +456,16 @@ namespace w::glsw
         bool y;
         bool z;
 
-        bvec3() : x{}, y{}, z{}
+        constexpr bvec3() : x{}, y{}, z{}
         {
         }
 
-        bvec3(bool x, bool y, bool z) : x{x}, y{y}, z{z}
+        constexpr bvec3(bool x, bool y, bool z) : x{x}, y{y}, z{z}
         {
         }
     };
 
-    inline vec3::vec3(bvec3 a) : x(a.x), y(a.y), z(a.z)
+    inline constexpr vec3::vec3(bvec3 a) : x(a.x), y(a.y), z(a.z)
     {
     }
 
@@ -543,11 +476,11 @@ namespace w::glsw
         bool z;
         bool w;
 
-        bvec4() : x{}, y{}, z{}, w{}
+        constexpr bvec4() : x{}, y{}, z{}, w{}
         {
         }
 
-        bvec4(bool x, bool y, bool z, bool w) : x{x}, y{y}, z{z}, w{w}
+        constexpr bvec4(bool x, bool y, bool z, bool w) : x{x}, y{y}, z{z}, w{w}
         {
         }
     };
@@ -556,35 +489,35 @@ namespace w::glsw
     {
         float x, y, z, w;
 
-        vec4() : x{}, y{}, z{}, w{}
+        constexpr vec4() : x{}, y{}, z{}, w{}
         {
         }
-        vec4(float i) : x{i}, y{i}, z{i}, w{i}
+        constexpr vec4(float i) : x{i}, y{i}, z{i}, w{i}
         {
         }
-        vec4(float x, float y, float z, float w) : x{x}, y{y}, z{z}, w{w}
+        constexpr vec4(float x, float y, float z, float w) : x{x}, y{y}, z{z}, w{w}
         {
         }
-        vec4(float a, float b, vec2 c) : x{a}, y{b}, z{c.x}, w{c.y}
+        constexpr vec4(float a, float b, vec2 c) : x{a}, y{b}, z{c.x}, w{c.y}
         {
         }
-        vec4(float a, vec2 b, float c) : x{a}, y{b.x}, z{b.y}, w{c}
+        constexpr vec4(float a, vec2 b, float c) : x{a}, y{b.x}, z{b.y}, w{c}
         {
         }
-        vec4(vec2 a, float z, float w) : x{a.x}, y{a.y}, z{z}, w{w}
+        constexpr vec4(vec2 a, float z, float w) : x{a.x}, y{a.y}, z{z}, w{w}
         {
         }
-        vec4(vec2 a, vec2 b) : x{a.x}, y{a.y}, z{b.x}, w{b.y}
+        constexpr vec4(vec2 a, vec2 b) : x{a.x}, y{a.y}, z{b.x}, w{b.y}
         {
         }
-        vec4(vec3 a, float w) : x{a.x}, y{a.y}, z{a.z}, w{w}
+        constexpr vec4(vec3 a, float w) : x{a.x}, y{a.y}, z{a.z}, w{w}
         {
         }
-        vec4(uvec4 a) : x(a.x), y(a.y), z(a.z), w(a.w)
+        constexpr vec4(uvec4 a) : x(a.x), y(a.y), z(a.z), w(a.w)
         {
         }
 
-        auto & operator--()
+        constexpr auto & operator--()
         {
             x--;
             y--;
@@ -592,105 +525,18 @@ namespace w::glsw
             w--;
             return *this;
         }
-        auto operator--(int)
+        constexpr auto operator--(int)
         {
             auto t = *this;
             --*this;
             return t;
         }
-        auto xy() const
-        {
-            return vec2{x, y};
-        }
-        auto xy(vec2 a)
-        {
-            x = a.x;
-            y = a.y;
-            return vec2{x, y};
-        }
-        auto xw() const
-        {
-            return vec2{x, w};
-        }
-        auto yx() const
-        {
-            return vec2{y, x};
-        }
-        auto yx(vec2 a)
-        {
-            y = a.x;
-            x = a.y;
-        }
-        auto yz() const
-        {
-            return vec2{y, z};
-        }
-        auto yw() const
-        {
-            return vec2{y, w};
-        }
-        auto xz() const
-        {
-            return vec2{x, z};
-        }
-        auto xz(vec2 a)
-        {
-            x = a.x;
-            z = a.y;
-        }
-        auto ww() const
-        {
-            return vec2{w, w};
-        }
-        auto xyz() const
-        {
-            return vec3{x, y, z};
-        }
-        auto xyz(vec3 a)
-        {
-            x = a.x;
-            y = a.y;
-            z = a.z;
-        }
-        auto yz(vec2 a)
-        {
-            y = a.x;
-            z = a.y;
-        }
-        auto zw()
-        {
-            return vec2{z, w};
-        }
-        auto grb(vec3 a)
-        {
-            y = a.x;
-            x = a.y;
-            z = a.z;
-        }
-        auto xxx() const
-        {
-            return vec3{x, x, x};
-        }
-        auto yyy() const
-        {
-            return vec3{y, y, y};
-        }
-        auto yzx() const
-        {
-            return vec3{y, z, x};
-        }
-        auto zzz() const
-        {
-            return vec3{z, z, z};
-        }
-        auto www() const
-        {
-            return vec3{w, w, w};
-        }
-        
+        W_SWIZZLES(4, W_GLSW_DECLARE_SWIZZLE, vec4, x, y, z, w)
+        W_SWIZZLES(4, W_GLSW_DECLARE_SWIZZLE, vec4, r, g, b, a)
+
         W_DEFINE_ARITHMETIC_ASSIGNMENT_OPERATORS(vec4, x, y, z, w)
 
-        auto operator*=(mat4 b) -> vec4 &;
+        constexpr auto operator*=(mat4 b) -> vec4 &;
 
         W_DEFINE_FRIEND_OPERATOR(vec4, +)
         W_DEFINE_FRIEND_OPERATOR(vec4, -)
@@ -698,52 +544,51 @@ namespace w::glsw
         W_DEFINE_FRIEND_OPERATOR(vec4, /)
     };
 
-    inline auto vec2::xxx() const -> vec3
-    {
-        return {x, x, x};
-    }
-
-    inline auto vec2::xxxx() const -> vec4
-    {
-        return  {x, x, x, x};
-    }
-
-    inline auto vec3::yyxy() const -> vec4
-    {
-        return {y, y, x, y};
-    }
-
-    inline auto vec3::zzzz() const -> vec4
-    {
-        return {z, z, z, z};
-    }
+    W_SWIZZLES(2, W_GLSW_DEFINE_SWIZZLE, vec2, x, y, , )
+    W_SWIZZLES(2, W_GLSW_DEFINE_SWIZZLE, vec2, r, g, , )
+    W_SWIZZLES(3, W_GLSW_DEFINE_SWIZZLE, vec3, x, y, z, )
+    W_SWIZZLES(3, W_GLSW_DEFINE_SWIZZLE, vec3, r, g, b, )
+    W_SWIZZLES(4, W_GLSW_DEFINE_SWIZZLE, vec4, x, y, z, w)
+    W_SWIZZLES(4, W_GLSW_DEFINE_SWIZZLE, vec4, r, g, b, a)
+
+#undef W_GLSW_DECLARE_SWIZZLE
+#undef W_GLSW_DEFINE_SWIZZLE
+
+    // Reads and writes reach the members their letters name, in order, and a name with a
+    // repeated letter can't be written. c++live.sh check_swizzle checks they cost nothing.
+    static_assert(vec4(1, 2, 3, 4).wzyx().x == 4 && vec4(1, 2, 3, 4).wzyx().w == 1);
+    static_assert(vec3(1, 2, 3).zzxy().y == 3 && vec3(1, 2, 3).zzxy().w == 2);
+    static_assert(vec4(1, 2, 3, 4).bgr().x == 3 && vec2(1, 2).yx().x == 2);
+    static_assert([] { auto v = vec3(1, 2, 3); v.zx(vec2(5, 6)); return v.x == 6 && v.y == 2 && v.z == 5; }());
+    static_assert([] { auto v = vec4(1, 2, 3, 4); return v.ab(vec2(5, 6)).x == 5 && v.w == 5 && v.z == 6; }());
+    static_assert([]<typename V>(V v) { return requires { v.xy(vec2()); } && !requires { v.xx(vec2()); }; }(vec2()));
 
     struct mat2
     {
         float a, b;
         float c, d;
-        mat2() : a{}, b{}, c{}, d{}
+        constexpr mat2() : a{}, b{}, c{}, d{}
         {
         }
-        explicit mat2(float a) : a{a}, b{a}, c{a}, d{a}
+        constexpr explicit mat2(float a) : a{a}, b{a}, c{a}, d{a}
         {
         }
-        explicit mat2(float a, float b, float c, float d) : a{a}, b{b}, c{c}, d{d}
+        constexpr explicit mat2(float a, float b, float c, float d) : a{a}, b{b}, c{c}, d{d}
         {
         }
-        explicit mat2(vec2 a, float b, float c) : a{a.x}, b{a.y}, c{b}, d{c}
+        constexpr explicit mat2(vec2 a, float b, float c) : a{a.x}, b{a.y}, c{b}, d{c}
         {
         }
-        explicit mat2(vec4 a) : a{a.x}, b{a.y}, c{a.z}, d{a.w}
+        constexpr explicit mat2(vec4 a) : a{a.x}, b{a.y}, c{a.z}, d{a.w}
         {
         }
 
-        auto operator*(float m) const
+        constexpr auto operator*(float m) const
         {
             return mat2{a * m, b * m, c * m, d * m};
         }
 
-        auto operator*(vec2 v) const
+        constexpr auto operator*(vec2 v) const
         {
             return vec2
             {
@@ -752,7 +597,7 @@ namespace w::glsw
             };
         }
 
-        auto operator*(mat2 v) const
+        constexpr auto operator*(mat2 v) const
         {
             return mat2
             {
@@ -764,19 +609,19 @@ namespace w::glsw
             };
         }
 
-        auto operator*=(mat2 v) // TODO: vice versa
+        constexpr auto operator*=(mat2 v) // TODO: vice versa
         {
             *this = *this * v;
         }
     };
 
-    inline auto operator*(vec2 a, mat2 b)
+    inline constexpr auto operator*(vec2 a, mat2 b)
     {
         a *= b;
         return a;
     }
 
-    inline auto vec2::operator*=(mat2 b) -> vec2 &
+    inline constexpr auto vec2::operator*=(mat2 b) -> vec2 &
     {
         *this = vec2
         {
@@ -792,14 +637,14 @@ namespace w::glsw
         float d,  e,  f;
         float g,  h,  i;
 
-        explicit mat3(float z) : 
+        constexpr explicit mat3(float z) : 
         a{z}, b{z}, c{z},
         d{z}, e{z}, f{z},
         g{z}, h{z}, i{z}
         {
         }
 
-        mat3
+        constexpr mat3
         (
             float a, float b, float c, 
             float d, float e, float f,
@@ -811,7 +656,7 @@ namespace w::glsw
         {
         }
 
-        mat3
+        constexpr mat3
         (
             vec3 a, 
             vec3 b,
@@ -823,7 +668,7 @@ namespace w::glsw
         {
         }
 
-        auto operator-(mat3 const & right) const
+        constexpr auto operator-(mat3 const & right) const
         {
             return mat3
             {
@@ -833,7 +678,7 @@ namespace w::glsw
             };
         }
 
-        auto operator*(vec3 v) const
+        constexpr auto operator*(vec3 v) const
         {
             return vec3
             {
@@ -843,7 +688,7 @@ namespace w::glsw
             };
         }
 
-        auto operator*(mat3 v) const
+        constexpr auto operator*(mat3 v) const
         {
             return mat3
             {
@@ -861,7 +706,7 @@ namespace w::glsw
             };
         }
 
-        auto operator[](std::size_t z)
+        constexpr auto operator[](std::size_t z)
         {
             switch (z)
             {
@@ -877,13 +722,13 @@ namespace w::glsw
         }
     };
 
-    inline auto operator*(vec3 a, mat3 b)
+    inline constexpr auto operator*(vec3 a, mat3 b)
     {
         a *= b;
         return a;
     }
 
-    inline auto vec3::operator*=(mat3 b) -> vec3 &
+    inline constexpr auto vec3::operator*=(mat3 b) -> vec3 &
     {
         *this = vec3
         {
@@ -901,7 +746,7 @@ namespace w::glsw
         float i, j, k, l;
         float m, n, o, p;
 
-        explicit mat4(float z) : 
+        constexpr explicit mat4(float z) : 
             a{z}, b{z}, c{z}, d{z}, 
             e{z}, f{z}, g{z}, h{z}, 
             i{z}, j{z}, k{z}, l{z},
@@ -909,7 +754,7 @@ namespace w::glsw
         {
         }
 
-        mat4
+        constexpr mat4
         (
             float a, float b, float c, float d, 
             float e, float f, float g, float h, 
@@ -923,7 +768,7 @@ namespace w::glsw
         {
         }
 
-        auto operator[](std::size_t z)
+        constexpr auto operator[](std::size_t z)
         {
             switch (z)
             {
@@ -941,13 +786,13 @@ namespace w::glsw
         }
     };
 
-    inline auto operator*(vec4 a, mat4 b)
+    inline constexpr auto operator*(vec4 a, mat4 b)
     {
         a *= b;
         return a;
     }
 
-    inline auto vec4::operator*=(mat4 b) -> vec4 &
+    inline constexpr auto vec4::operator*=(mat4 b) -> vec4 &
     {
         *this = vec4
         {
@@ -960,408 +805,723 @@ namespace w::glsw
         return *this;
     }
 
-    inline auto vec2::xyy() const -> vec3
-    {
-        return {x, y, y};
-    }
-
-    inline auto vec2::xyx() const -> vec3
-    {
-        return  {x, y, x};
-    }
-
-    inline auto vec2::xxy() const -> vec3
-    {
-        return  {x, x, y};
-    }
-
-    inline auto vec2::yxy() const -> vec3
-    {
-        return {y, x, y};
-    }
-
-    inline auto vec2::yyx() const -> vec3
-    {
-        return  {y, y, x};
-    }
-
-    inline auto vec2::yxx() const -> vec3
-    {
-        return  {y, x, x};
-    }
-
-    inline auto vec2::yyy() const -> vec3
-    {
-        return  {y, y, y};
-    }
-
     struct rgb
     {
         float r;
         float g;
         float b;
 
-        operator vec3() const
+        constexpr operator vec3() const
         {
             return vec3{r, g, b};
         }
 
-        auto rrr() const
+        constexpr auto rrr() const
         {
             return vec3{r, r, r};
         }
     };
 
-    struct sampler2D
+    // linear is row-major. blocks stores 4x4 texel blocks contiguously, row-major among
+    // themselves, so stepping vertically stays within 256 bytes instead of a whole row.
+    enum class texel_layout
+    {
+        linear,
+        blocks
+    };
+
+    // Texels are kept as floats in a full mip chain, all levels in one buffer, each level
+    // from the bottom row like fragment coordinates.
+    class sampler2D
     {
-        std::size_t width;
-        std::size_t height;
-        std::vector<std::uint32_t> data;
+    public:
+        struct level
+        {
+            std::size_t width;
+            std::size_t height;
+            std::size_t offset;
+        };
+
+    private:
+        std::vector<level> mips;
+        std::span<vec4 const> texels; // into owned or whatever external keeps alive, e.g. a mapped file
+        std::vector<vec4> owned;
+        std::shared_ptr<void const> external;
+        texel_layout layout = texel_layout::linear;
+
+        auto index(level const & l, std::size_t x, std::size_t y) const
+        {
+            return layout == texel_layout::linear ?
+                l.offset + y * l.width + x :
+                l.offset + ((y >> 2) * ((l.width + 3) >> 2) + (x >> 2)) * 16 + (y & 3) * 4 + (x & 3);
+        }
+
+        auto level_size(std::size_t w, std::size_t h) const
+        {
+            return layout == texel_layout::linear ? w * h : ((w + 3) >> 2) * ((h + 3) >> 2) * 16;
+        }
+
+        auto build_mips(std::span<vec4> target)
+        {
+            for (auto l = std::size_t{1}; l != mips.size(); ++l)
+            {
+                auto const & s = mips[l - 1];
+                auto const & d = mips[l];
+                auto const rows = std::views::iota(std::size_t{}, d.height);
+
+                // 2x2 box filter, odd sizes repeat their last row or column.
+                std::for_each
+                (
+                    std::execution::par,
+                    rows.begin(), rows.end(),
+                    [&](std::size_t y)
+                    {
+                        auto const y0 = std::min(2 * y, s.height - 1);
+                        auto const y1 = std::min(2 * y + 1, s.height - 1);
+                        for (auto x = std::size_t{}; x != d.width; ++x)
+                        {
+                            auto const x0 = std::min(2 * x, s.width - 1);
+                            auto const x1 = std::min(2 * x + 1, s.width - 1);
+                            auto const & a = target[index(s, x0, y0)];
+                            auto const & b = target[index(s, x1, y0)];
+                            auto const & c = target[index(s, x0, y1)];
+                            auto const & e = target[index(s, x1, y1)];
+                            target[index(d, x, y)] = vec4
+                            {
+                                (a.x + b.x + c.x + e.x) * .25f,
+                                (a.y + b.y + c.y + e.y) * .25f,
+                                (a.z + b.z + c.z + e.z) * .25f,
+                                (a.w + b.w + c.w + e.w) * .25f
+                            };
+                        }
+                    }
+                );
+            }
+        }
 
+    public:
         sampler2D() = default;
         sampler2D(sampler2D const &) = delete;
         auto operator=(sampler2D const &) = delete;
+
+        // source(x, y) returns the texel in column x of row y, rows counted from the top as
+        // images are stored. It is called once per texel, in parallel, then the mips are built.
+        // Storage is reused when the size stays the same, so render targets can be
+        // reassigned every frame.
+        auto assign(std::size_t width, std::size_t height, auto source, texel_layout l = texel_layout::linear, bool mipmaps = true)
+        {
+            layout = l;
+            mips.clear();
+            auto total = std::size_t{};
+            for (auto w = width, h = height; w && h; w = mipmaps && (w > 1 || h > 1) ? std::max(w / 2, std::size_t{1}) : 0, h = std::max(h / 2, std::size_t{1}))
+            {
+                mips.push_back({w, h, total});
+                total += level_size(w, h);
+            }
+            external.reset();
+            owned.resize(total);
+            auto const target = std::span<vec4>{owned};
+
+            auto const rows = std::views::iota(std::size_t{}, height);
+            std::for_each
+            (
+                std::execution::par,
+                rows.begin(), rows.end(),
+                [&](std::size_t y)
+                {
+                    for (auto x = std::size_t{}; x != width; ++x)
+                    {
+                        target[index(mips.front(), x, y)] = source(x, height - 1 - y);
+                    }
+                }
+            );
+
+            build_mips(target);
+
+            texels = target;
+        }
+
+        // A single linear level for the caller to fill, rows from the bottom, e.g. by rendering
+        // into it. Storage is reused when the size stays the same.
+        auto assign(std::size_t width, std::size_t height) -> std::span<vec4>
+        {
+            layout = texel_layout::linear;
+            mips.clear();
+            if (width && height)
+            {
+                mips.push_back({width, height, 0});
+            }
+            external.reset();
+            owned.resize(width * height);
+            texels = owned;
+            return owned;
+        }
+
+        // Uses texels that are already laid out and mipmapped, e.g. mapped from a cache file.
+        // owner keeps them alive.
+        auto adopt(std::span<level const> l, std::span<vec4 const> t, texel_layout tl, std::shared_ptr<void const> owner)
+        {
+            mips.assign(l.begin(), l.end());
+            texels = t;
+            owned = {};
+            external = std::move(owner);
+            layout = tl;
+        }
+
+        auto data() const
+        {
+            return texels;
+        }
+
+        // Packed BGRA rows, stride in pixels.
+        auto assign(std::size_t width, std::size_t height, std::uint32_t const * bgra, std::size_t stride, texel_layout l = texel_layout::linear)
+        {
+            assign
+            (
+                width, height,
+                [=](std::size_t x, std::size_t y)
+                {
+                    auto const c = bgra[y * stride + x];
+                    return vec4
+                    {
+                        float((c >> 16) & 0xff) / 255.f,
+                        float((c >> 8) & 0xff) / 255.f,
+                        float(c & 0xff) / 255.f,
+                        float(c >> 24) / 255.f
+                    };
+                },
+                l
+            );
+        }
+
+        auto width() const
+        {
+            return mips.empty() ? std::size_t{} : mips.front().width;
+        }
+
+        auto height() const
+        {
+            return mips.empty() ? std::size_t{} : mips.front().height;
+        }
+
+        auto levels() const -> std::span<level const>
+        {
+            return mips;
+        }
+
+        auto get_layout() const
+        {
+            return layout;
+        }
+
+        // x and y must already be inside the level.
+        auto texel(level const & l, std::size_t x, std::size_t y) const -> vec4 const &
+        {
+            return texels[index(l, x, y)];
+        }
     };
 
-    inline auto iTime = 0.0f;
-    inline auto iDate = vec4{};
-    inline auto iFrame = 0;
-    inline auto iMouse = vec3{};
-    inline auto iResolution = vec3{100, 100, 1};
-    inline auto iChannel0 = sampler2D{};
-    inline auto iChannel1 = sampler2D{};
-    inline auto iChannel2 = sampler2D{};
-    inline auto iChannel3 = sampler2D{};
-    // inline auto iChannelResolution = std::array<vec2, 4>{};
+    // What the hosts load textures into, bound to iChannel0..3 unless a pass binds
+    // something else.
+    inline auto channel_textures = std::array<sampler2D, 4>{};
 
-    inline auto length(vec2 a)
+    // Shader code uses iChannelN where a sampler2D is expected, the conversion follows the
+    // current binding.
+    struct channel
     {
-        return std::hypot(a.x, a.y);
-    }
-    inline auto length(vec3 a)
+        sampler2D * bound;
+
+        operator sampler2D & () const
+        {
+            return *bound;
+        }
+    };
+
+    struct uniforms
     {
-        return std::hypot(a.x, a.y, a.z);
-    }
+        float iTime = 0.0f;
+        vec4 iDate = {};
+        int iFrame = 0;
+        vec3 iMouse = {};
+        vec3 iResolution = {100, 100, 1};
+        std::array<sampler2D *, 4> iChannel = {&channel_textures[0], &channel_textures[1], &channel_textures[2], &channel_textures[3]};
+        void const * state = nullptr; // what the shader's prepare returned for this frame
+    };
 
-    inline auto distance(vec2 a, vec2 b)
+    // Per-frame uniforms are thread local: render binds its own uniforms on whichever
+    // worker runs a tile, so several render calls can share the thread pool.
+    inline thread_local auto iTime = 0.0f;
+    inline thread_local auto iDate = vec4{};
+    inline thread_local auto iFrame = 0;
+    inline thread_local auto iMouse = vec3{};
+    inline thread_local auto iResolution = vec3{100, 100, 1};
+    inline thread_local auto iChannel0 = channel{&channel_textures[0]};
+    inline thread_local auto iChannel1 = channel{&channel_textures[1]};
+    inline thread_local auto iChannel2 = channel{&channel_textures[2]};
+    inline thread_local auto iChannel3 = channel{&channel_textures[3]};
+    inline thread_local auto prepared_state = static_cast<void const *>(nullptr);
+
+    // Bumped whenever scoped_uniforms rebinds, so per-thread caches can tell they are stale.
+    inline thread_local auto uniforms_generation = std::uint64_t{};
+
+    struct scoped_uniforms
     {
-        return length(a - b);
-    }
-    inline auto distance(vec3 a, vec3 b)
+        uniforms saved;
+
+        static auto current()
+        {
+            return uniforms{iTime, iDate, iFrame, iMouse, iResolution, {iChannel0.bound, iChannel1.bound, iChannel2.bound, iChannel3.bound}, prepared_state};
+        }
+        static auto assign(uniforms const & u)
+        {
+            iTime = u.iTime;
+            iDate = u.iDate;
+            iFrame = u.iFrame;
+            iMouse = u.iMouse;
+            iResolution = u.iResolution;
+            iChannel0.bound = u.iChannel[0];
+            iChannel1.bound = u.iChannel[1];
+            iChannel2.bound = u.iChannel[2];
+            iChannel3.bound = u.iChannel[3];
+            prepared_state = u.state;
+            ++uniforms_generation;
+        }
+
+        explicit scoped_uniforms(uniforms const & u) : saved{current()}
+        {
+            assign(u);
+        }
+        ~scoped_uniforms()
+        {
+            assign(saved);
+        }
+        scoped_uniforms(scoped_uniforms &&) = delete;
+        auto operator=(scoped_uniforms &&) = delete;
+    };
+
+    // inline auto iChannelResolution = std::array<vec2, 4>{};
+
+    inline constexpr auto length(vec2 a)
     {
-        return length(a - b);
+        if consteval
+        {
+            return float(math::constant::sqrt(double(a.x) * a.x + double(a.y) * a.y));
+        }
+        else
+        {
+            return std::hypot(a.x, a.y);
+        }
     }
-    inline auto sqrt(float a)
+    inline constexpr auto length(vec3 a)
     {
-        return a < 0 ? NAN : std::sqrt(a);
+        if consteval
+        {
+            return float(math::constant::sqrt(double(a.x) * a.x + double(a.y) * a.y + double(a.z) * a.z));
+        }
+        else
+        {
+            return std::hypot(a.x, a.y, a.z);
+        }
+    }
+
+    inline constexpr auto distance(vec2 a, vec2 b)
+    {
+        return length(a - b);
+    }
+    inline constexpr auto distance(vec3 a, vec3 b)
+    {
+        return length(a - b);
     }
-    inline auto sqrt(vec2 a)
+    inline constexpr auto sqrt(float a)
+    {
+        if consteval
+        {
+            return float(math::constant::sqrt(a));
+        }
+        else
+        {
+            return a < 0 ? NAN : std::sqrt(a);
+        }
+    }
+    inline constexpr auto sqrt(vec2 a)
     {
         return vec2{sqrt(a.x), sqrt(a.y)};
     }
-    inline auto sqrt(vec3 a)
+    inline constexpr auto sqrt(vec3 a)
     {
         return vec3{sqrt(a.x), sqrt(a.y), sqrt(a.z)};
     }
-    inline auto sqrt(vec4 a)
+    inline constexpr auto sqrt(vec4 a)
     {
         return vec4{sqrt(a.x), sqrt(a.y), sqrt(a.z), sqrt(a.w)};
     }
-    inline auto normalize(vec2 a)
+    inline constexpr auto normalize(vec2 a)
     {
         return a / length(a);
     }
-    inline auto normalize(vec3 a)
+    inline constexpr auto normalize(vec3 a)
     {
         return a / length(a);
     }
-    inline auto dot(vec2 a, vec2 b)
+    inline constexpr auto dot(vec2 a, vec2 b)
     {
         return a.x * b.x + a.y * b.y;
     }
-    inline auto dot(vec3 a, vec3 b)
+    inline constexpr auto dot(vec3 a, vec3 b)
     {
         return a.x * b.x + a.y * b.y + a.z * b.z;
     }
-    inline auto radians(float a)
+    inline constexpr auto radians(float a)
     {
         return a / 180 * std::numbers::pi_v<float>;
     }
-    inline auto radians(vec3 a)
+    inline constexpr auto radians(vec3 a)
     {
         return vec3{radians(a.x), radians(a.y), radians(a.z)};
     }
-    inline auto sin(float a)
+    inline constexpr auto sin(float a)
     {
-        return std::sin(a);
+        if consteval
+        {
+            return float(math::constant::sin(a));
+        }
+        else
+        {
+            return std::sin(a);
+        }
     }
-    inline auto sin(vec2 a)
+    template<typename = void>
+    constexpr auto sin(vec2 a)
     {
         return vec2(sin(a.x), sin(a.y));
     }
-    inline auto sin(vec3 a)
+    template<typename = void>
+    constexpr auto sin(vec3 a)
     {
         return vec3(sin(a.x), sin(a.y), sin(a.z));
     }
-    inline auto sin(vec4 a)
+    template<typename = void>
+    constexpr auto sin(vec4 a)
     {
         return vec4(sin(a.x), sin(a.y), sin(a.z), sin(a.w));
     }
-    inline auto cos(float a)
+    inline constexpr auto cos(float a)
     {
-        return std::cos(a);
+        if consteval
+        {
+            return float(math::constant::cos(a));
+        }
+        else
+        {
+            return std::cos(a);
+        }
     }
-    inline auto cos(vec2 a)
+    template<typename = void>
+    constexpr auto cos(vec2 a)
     {
         return vec2{cos(a.x), cos(a.y)};
     }
-    inline auto cos(vec3 a)
+    template<typename = void>
+    constexpr auto cos(vec3 a)
     {
         return vec3{cos(a.x), cos(a.y), cos(a.z)};
     }
-    inline auto cos(vec4 a)
+    template<typename = void>
+    constexpr auto cos(vec4 a)
     {
         return vec4{cos(a.x), cos(a.y), cos(a.z), cos(a.w)};
     }
-    inline auto tanh(float a)
+    inline constexpr auto tanh(float a)
     {
-        return std::tanh(a);
+        if consteval
+        {
+            return float(math::constant::tanh(a));
+        }
+        else
+        {
+            return std::tanh(a);
+        }
     }
-    inline auto tanh(vec3 a)
+    template<typename = void>
+    constexpr auto tanh(vec3 a)
     {
         return vec3{tanh(a.x), tanh(a.y), tanh(a.z)};
     }
-    inline auto atan(float a, float b)
+    inline constexpr auto atan(float a, float b)
     {
-        return std::atan2(a, b);
+        if consteval
+        {
+            return float(math::constant::atan2(a, b));
+        }
+        else
+        {
+            return std::atan2(a, b);
+        }
     }
-    inline auto atan(float a)
+    inline constexpr auto atan(float a)
     {
-        return std::atan(a);
+        if consteval
+        {
+            return float(math::constant::atan(a));
+        }
+        else
+        {
+            return std::atan(a);
+        }
     }
-    inline auto min(float a, float b)
+    inline constexpr auto min(float a, float b)
     {
         return std::min(a, b);
     }
-    inline auto min(double a, double b) // TODO: remove
+    inline constexpr auto min(double a, double b) // TODO: remove
     {
         return std::min(float(a), float(b));
     }
-    inline auto min(float a, double b) // TODO: remove
+    inline constexpr auto min(float a, double b) // TODO: remove
     {
         return std::min(a, float(b));
     }
-    inline auto min(double a, float b) // TODO: remove
+    inline constexpr auto min(double a, float b) // TODO: remove
     {
         return std::min(float(a), b);
     }
-    inline auto min(int a, int b)
+    inline constexpr auto min(int a, int b)
     {
         return std::min(a, b);
     }
-    inline auto min(vec2 a, vec2 b)
+    inline constexpr auto min(vec2 a, vec2 b)
     {
         return vec2(min(a.x, b.x), min(a.y, b.y));
     }
-    inline auto min(vec3 a, vec3 b)
+    inline constexpr auto min(vec3 a, vec3 b)
     {
         return vec3(min(a.x, b.x), min(a.y, b.y), min(a.z, b.z));
     }
-    inline auto min(ivec3 a, ivec3 b)
+    inline constexpr auto min(ivec3 a, ivec3 b)
     {
         return ivec3(min(a.x, b.x), min(a.y, b.y), min(a.z, b.z));
     }
-    inline auto min(vec3 a, float b)
+    inline constexpr auto min(vec3 a, float b)
     {
         return vec3{min(a.x, b), min(a.y, b), min(a.z, b)};
     }
-    inline auto max(float a, float b)
+    inline constexpr auto max(float a, float b)
     {
         return std::max(a, b);
     }
-    inline auto max(double a, double b) // TODO: remove
+    inline constexpr auto max(double a, double b) // TODO: remove
     {
         return std::max(float(a), float(b));
     }
-    inline auto max(double a, float b) // TODO: remove
+    inline constexpr auto max(double a, float b) // TODO: remove
     {
         return std::max(float(a), b);
     }
-    inline auto max(float a, double b) // TODO: remove
+    inline constexpr auto max(float a, double b) // TODO: remove
     {
         return std::max(a, float(b));
     }
-    inline auto max(int a, int b)
+    inline constexpr auto max(int a, int b)
     {
         return std::max(a, b);
     }
-    inline auto max(vec2 a, float b)
+    inline constexpr auto max(vec2 a, float b)
     {
         return vec2{max(a.x, b), max(a.y, b)};
     }
-    inline auto max(vec3 a, float b)
+    inline constexpr auto max(vec3 a, float b)
     {
         return vec3{max(a.x, b), max(a.y, b), max(a.z, b)};
     }
-    inline auto max(vec4 a, float b)
+    inline constexpr auto max(vec4 a, float b)
     {
         return vec4{max(a.x, b), max(a.y, b), max(a.z, b), max(a.w, b)};
     }
-    inline auto max(float a, vec3 b)
+    inline constexpr auto max(float a, vec3 b)
     {
         return vec3{max(a, b.x), max(a, b.y), max(a, b.z)};
     }
-    inline auto max(vec2 a, vec2 b)
+    inline constexpr auto max(vec2 a, vec2 b)
     {
         return vec2{max(a.x, b.x), max(a.y, b.y)};
     }
-    inline auto max(vec3 a, vec3 b)
+    inline constexpr auto max(vec3 a, vec3 b)
     {
         return vec3{max(a.x, b.x), max(a.y, b.y), max(a.z, b.z)};
     }
-    inline auto max(ivec3 a, ivec3 b)
+    inline constexpr auto max(ivec3 a, ivec3 b)
     {
         return ivec3{max(a.x, b.x), max(a.y, b.y), max(a.z, b.z)};
     }
-    inline auto abs(float a)
+    inline constexpr auto abs(float a)
     {
-        return std::abs(a);
+        if consteval
+        {
+            return float(math::constant::fabs(a));
+        }
+        else
+        {
+            return std::abs(a);
+        }
     }
-    inline auto abs(int a)
+    inline constexpr auto abs(int a)
     {
-        return std::abs(a);
+        return a < 0 ? -a : a;
     }
-    inline auto abs(vec2 a)
+    inline constexpr auto abs(vec2 a)
     {
         return vec2{abs(a.x), abs(a.y)};
     }
-    inline auto abs(vec3 a)
+    inline constexpr auto abs(vec3 a)
     {
         return vec3{abs(a.x), abs(a.y), abs(a.z)};
     }
-    inline auto abs(ivec3 a)
+    inline constexpr auto abs(ivec3 a)
     {
         return ivec3{abs(a.x), abs(a.y), abs(a.z)};
     }
-    inline auto abs(vec4 a)
+    inline constexpr auto abs(vec4 a)
     {
         return vec4{abs(a.x), abs(a.y), abs(a.z), abs(a.w)};
     }
-    inline auto log(float a)
+    inline constexpr auto log(float a)
     {
-        return std::log(a);
+        if consteval
+        {
+            return float(math::constant::log(a));
+        }
+        else
+        {
+            return std::log(a);
+        }
     }
-    inline auto log(vec3 a)
+    template<typename = void>
+    constexpr auto log(vec3 a)
     {
         return vec3{log(a.x), log(a.y), log(a.z)};
     }
-    inline auto exp(float a)
+    inline constexpr auto exp(float a)
     {
-        return std::exp(a);
+        if consteval
+        {
+            return float(math::constant::exp(a));
+        }
+        else
+        {
+            return std::exp(a);
+        }
     }
-    inline auto exp(vec3 a)
+    template<typename = void>
+    constexpr auto exp(vec3 a)
     {
         return vec3{exp(a.x), exp(a.y), exp(a.z)};
     }
-    inline auto ceil(float a)
+    inline constexpr auto ceil(float a)
     {
-        return std::ceil(a);
+        if consteval
+        {
+            return float(math::constant::ceil(a));
+        }
+        else
+        {
+            return std::ceil(a);
+        }
     }
-    inline auto ceil(vec2 a)
+    inline constexpr auto ceil(vec2 a)
     {
         return vec2{ceil(a.x), ceil(a.y)};
     }
-    inline auto ceil(vec3 a)
+    inline constexpr auto ceil(vec3 a)
     {
         return vec3{ceil(a.x), ceil(a.y), ceil(a.z)};
     }
-    inline auto clamp(float a, float b, float c)
+    inline constexpr auto clamp(float a, float b, float c)
     {
         return std::clamp(a, b, c);
     }
-    inline auto clamp(vec2 a, float b, float c)
+    inline constexpr auto clamp(vec2 a, float b, float c)
     {
         return vec2(clamp(a.x, b, c), clamp(a.y, b, c));
     }
-    inline auto clamp(vec3 a, float b, float c)
+    inline constexpr auto clamp(vec3 a, float b, float c)
     {
         return vec3(clamp(a.x, b, c), clamp(a.y, b, c), clamp(a.z, b, c));
     }
-    inline auto clamp(vec2 a, vec2 b, vec2 c)
+    inline constexpr auto clamp(vec2 a, vec2 b, vec2 c)
     {
         return vec2(clamp(a.x, b.x, c.x), clamp(a.y, b.y, c.y));
     }
-    inline auto clamp(vec3 a, vec3 b, vec3 c)
+    inline constexpr auto clamp(vec3 a, vec3 b, vec3 c)
     {
         return vec3(clamp(a.x, b.x, c.x), clamp(a.y, b.y, c.y), clamp(a.z, b.z, c.z));
     }
-    inline auto clamp(vec4 a, vec4 b, vec4 c)
+    inline constexpr auto clamp(vec4 a, vec4 b, vec4 c)
     {
         return vec4(clamp(a.x, b.x, c.x), clamp(a.y, b.y, c.y), clamp(a.z, b.z, c.z), clamp(a.w, b.w, c.w));
     }
-    inline auto step(float a, float b)
+    inline constexpr auto step(float a, float b)
     {
         return b < a ? 0.f : 1.f;
     }
-    inline auto step(float a, vec2 b)
+    inline constexpr auto step(float a, vec2 b)
     {
         return vec2{step(a, b.x), step(a, b.y)};
     }
-    inline auto step(float a, vec3 b)
+    inline constexpr auto step(float a, vec3 b)
     {
         return vec3{step(a, b.x), step(a, b.y), step(a, b.z)};
     }
-    inline auto step(float a, vec4 b)
+    inline constexpr auto step(float a, vec4 b)
     {
         return vec4{step(a, b.x), step(a, b.y), step(a, b.z), step(a, b.w)};
     }
-    inline auto step(vec3 a, vec3 b)
+    inline constexpr auto step(vec3 a, vec3 b)
     {
         return vec3{step(a.x, b.x), step(a.y, b.y), step(a.z, b.z)};
     }
-    inline auto step(vec4 a, vec4 b)
+    inline constexpr auto step(vec4 a, vec4 b)
     {
         return vec4{step(a.x, b.x), step(a.y, b.y), step(a.z, b.z), step(a.w, b.w)};
     }
-    inline auto mix(float edge0, float edge1, float x)
+    inline constexpr auto mix(float edge0, float edge1, float x)
     {
         return edge0 * (1 - x) + edge1 * x;
     }
-    inline auto mix(vec2 edge0, vec2 edge1, float x)
+    inline constexpr auto mix(vec2 edge0, vec2 edge1, float x)
     {
         return edge0 * (1 - x) + edge1 * x;
     }
-    inline auto mix(vec3 edge0, vec3 edge1, float x)
+    inline constexpr auto mix(vec3 edge0, vec3 edge1, float x)
     {
         return edge0 * (1 - x) + edge1 * x;
     }
-    inline auto mix(vec4 edge0, vec4 edge1, float x)
+    inline constexpr auto mix(vec4 edge0, vec4 edge1, float x)
     {
         return edge0 * (1 - x) + edge1 * x;
     }
-    inline auto mix(vec3 edge0, vec3 edge1, vec3 x)
+    inline constexpr auto mix(vec3 edge0, vec3 edge1, vec3 x)
     {
         return vec3{mix(edge0.x, edge1.x, x.x), mix(edge0.y, edge1.y, x.y), mix(edge0.z, edge1.z, x.z)};
     }
-    inline auto unmix(float edge0, float edge1, float x)
+    inline constexpr auto unmix(float edge0, float edge1, float x)
     {
         auto const p = edge1 - edge0;
         return p ? (x - edge0) / p : x < edge0 ? 1.f : 0.f;
     }
-    inline auto smoothstep(float edge0, float edge1, float x)
+    inline constexpr auto smoothstep(float edge0, float edge1, float x)
     {
         auto const r = clamp(unmix(edge0, edge1, x), 0.f, 1.f);
         return r * r * (3 - 2 * r);
     }
-    inline auto smoothstep(float edge0, float edge1, vec2 a)
+    inline constexpr auto smoothstep(float edge0, float edge1, vec2 a)
     {
         return vec2{smoothstep(edge0, edge1, a.x), smoothstep(edge0, edge1, a.y)};
     }
-    inline auto smoothstep(float edge0, float edge1, vec3 a)
+    inline constexpr auto smoothstep(float edge0, float edge1, vec3 a)
     {
         return vec3{smoothstep(edge0, edge1, a.x), smoothstep(edge0, edge1, a.y), smoothstep(edge0, edge1, a.z)};
     }
-    inline auto cross(vec3 a, vec3 b)
+    inline constexpr auto cross(vec3 a, vec3 b)
     {
         return vec3
         {
@@ -1370,91 +1530,105 @@ namespace w::glsw
             a.x * b.y - b.x * a.y
         };
     }
-    inline auto floor(float a)
+    inline constexpr auto floor(float a)
     {
-        return std::floor(a);
+        if consteval
+        {
+            return float(math::constant::floor(a));
+        }
+        else
+        {
+            return std::floor(a);
+        }
     }
-    inline auto floor(vec2 a)
+    inline constexpr auto floor(vec2 a)
     {
         return vec2{floor(a.x), floor(a.y)};
     }
-    inline auto floor(vec3 a)
+    inline constexpr auto floor(vec3 a)
     {
         return vec3{floor(a.x), floor(a.y), floor(a.z)};
     }
-    inline auto floor(vec4 a)
+    inline constexpr auto floor(vec4 a)
     {
         return vec4{floor(a.x), floor(a.y), floor(a.z), floor(a.w)};
     }
-    inline auto fract(float a)
+    inline constexpr auto fract(float a)
     {
         return a - floor(a);
     }
-    inline auto fract(vec2 a)
+    inline constexpr auto fract(vec2 a)
     {
         return a - floor(a);
     }
-    inline auto fract(vec3 a)
+    inline constexpr auto fract(vec3 a)
     {
         return a - floor(a);
     }
-    inline auto fract(vec4 a)
+    inline constexpr auto fract(vec4 a)
     {
         return a - floor(a);
     }
-    inline auto round(float a)
+    inline constexpr auto round(float a)
     {
-        return std::round(a);
+        if consteval
+        {
+            return float(math::constant::round(a));
+        }
+        else
+        {
+            return std::round(a);
+        }
     }
-    inline auto round(vec2 a)
+    inline constexpr auto round(vec2 a)
     {
         return vec2{round(a.x), round(a.y)};
     }
-    inline auto mod(float a, float b)
+    inline constexpr auto mod(float a, float b)
     {
         return a - b * floor(a / b);
     }
-    inline auto mod(vec2 a, float b)
+    inline constexpr auto mod(vec2 a, float b)
     {
         return vec2{mod(a.x, b), mod(a.y, b)};
     }
-    inline auto mod(vec3 a, float b)
+    inline constexpr auto mod(vec3 a, float b)
     {
         return vec3{mod(a.x, b), mod(a.y, b), mod(a.z, b)};
     }
-    inline auto mod(vec4 a, float b)
+    inline constexpr auto mod(vec4 a, float b)
     {
         return vec4{mod(a.x, b), mod(a.y, b), mod(a.z, b), mod(a.w, b)};
     }
-    inline auto mod(vec2 a, vec2 b)
+    inline constexpr auto mod(vec2 a, vec2 b)
     {
         return vec2{mod(a.x, b.x), mod(a.y, b.y)};
     }
-    inline auto mod(vec3 a, vec3 b)
+    inline constexpr auto mod(vec3 a, vec3 b)
     {
         return vec3{mod(a.x, b.x), mod(a.y, b.y), mod(a.z, b.z)};
     }
-    inline auto sign(float a)
+    inline constexpr auto sign(float a)
     {
         return a < 0 ? -1.f : a > 0 ? 1.f : 0.f;
     }
-    inline auto sign(int a)
+    inline constexpr auto sign(int a)
     {
         return a < 0 ? -1 : a > 0 ? 1 : 0;
     }
-    inline auto sign(vec2 a)
+    inline constexpr auto sign(vec2 a)
     {
         return vec2{sign(a.x), sign(a.y)};
     }
-    inline auto sign(vec3 a)
+    inline constexpr auto sign(vec3 a)
     {
         return vec3{sign(a.x), sign(a.y), sign(a.z)};
     }
-    inline auto sign(ivec3 a)
+    inline constexpr auto sign(ivec3 a)
     {
         return ivec3{sign(a.x), sign(a.y), sign(a.z)};
     }
-    inline auto refract(vec3 a, vec3 b, float c)
+    inline constexpr auto refract(vec3 a, vec3 b, float c)
     {
         auto const k = 1.0f - c * c * (1.0f - dot(b, a) * dot(b, a));
         if (k < 0.0f)
@@ -1462,31 +1636,143 @@ namespace w::glsw
         else
             return c * a - (c * dot(b, a) + sqrt(k)) * b;
     }
-    inline auto reflect(vec3 a, vec3 b)
+    inline constexpr auto reflect(vec3 a, vec3 b)
     {
         return a - 2.0f * dot(b, a) * b;
     }
-    inline vec3 faceforward(vec3 a, vec3 b, vec3 c)
+    inline constexpr vec3 faceforward(vec3 a, vec3 b, vec3 c)
     {
         return dot(c, b) < 0 ? a : -a;
     }
-    inline auto pow(float a, float b)
+    inline constexpr auto pow(float a, float b)
     {
-        return std::pow(a, b);
+        if consteval
+        {
+            return float(math::constant::pow(a, b));
+        }
+        else
+        {
+            return std::pow(a, b);
+        }
     }
-    inline auto pow(vec3 a, vec3 b)
+    template<typename = void>
+    constexpr auto pow(vec3 a, vec3 b)
     {
         return vec3{pow(a.x, b.x), pow(a.y, b.y), pow(a.z, b.z)};
     }
-    inline auto pow(vec4 a, vec4 b)
+    template<typename = void>
+    constexpr auto pow(vec4 a, vec4 b)
     {
         return vec4{pow(a.x, b.x), pow(a.y, b.y), pow(a.z, b.z), pow(a.w, b.w)};
     }
-    inline auto floatBitsToUint(float a)
+
+    // What USING_W_GLSW_AS picks sin, cos, tanh, atan, exp, log and pow from. Their vector
+    // overloads above are templates only so that those of fast and mediump win over them
+    // when argument-dependent lookup brings them in too. Each precision has them for
+    // simd::lanes as well, a loop over its own float version, so a packet overload shades
+    // like the scalar mainImage; only fast and mediump vectorize, exact calls libm per lane.
+#define W_GLSW_LANES_UNARY(f)                                              \
+    inline constexpr auto f(simd::lanes const & a)                         \
+    {                                                                      \
+        return simd::each([](float x) { return f(x); }, a);                \
+    }                                                                      \
+    /**/
+#define W_GLSW_LANES_BINARY(f)                                             \
+    inline constexpr auto f(simd::lanes const & a, simd::lanes const & b)  \
+    {                                                                      \
+        return simd::each([](float x, float y) { return f(x, y); }, a, b); \
+    }                                                                      \
+    /**/
+
+    namespace exact
+    {
+        using w::glsw::sin;
+        using w::glsw::cos;
+        using w::glsw::tanh;
+        using w::glsw::atan;
+        using w::glsw::exp;
+        using w::glsw::log;
+        using w::glsw::pow;
+
+        W_GLSW_LANES_UNARY(sin)
+        W_GLSW_LANES_UNARY(cos)
+        W_GLSW_LANES_UNARY(tanh)
+        W_GLSW_LANES_UNARY(atan)
+        W_GLSW_LANES_UNARY(exp)
+        W_GLSW_LANES_UNARY(log)
+        W_GLSW_LANES_BINARY(atan)
+        W_GLSW_LANES_BINARY(pow)
+    }
+
+#define W_GLSW_APPROXIMATE_UNARY(f, p)                                   \
+    inline constexpr auto f(float a)                                     \
+    {                                                                    \
+        return math::approximate::f<math::approximate::precision::p>(a); \
+    }                                                                    \
+    inline constexpr auto f(vec2 a)                                      \
+    {                                                                    \
+        return vec2{f(a.x), f(a.y)};                                     \
+    }                                                                    \
+    inline constexpr auto f(vec3 a)                                      \
+    {                                                                    \
+        return vec3{f(a.x), f(a.y), f(a.z)};                             \
+    }                                                                    \
+    inline constexpr auto f(vec4 a)                                      \
+    {                                                                    \
+        return vec4{f(a.x), f(a.y), f(a.z), f(a.w)};                     \
+    }                                                                    \
+    W_GLSW_LANES_UNARY(f)                                                \
+    /**/
+
+#define W_GLSW_APPROXIMATE(p)                                                        \
+    namespace p                                                                      \
+    {                                                                                \
+        W_GLSW_APPROXIMATE_UNARY(sin, p)                                             \
+        W_GLSW_APPROXIMATE_UNARY(cos, p)                                             \
+        W_GLSW_APPROXIMATE_UNARY(tanh, p)                                            \
+        W_GLSW_APPROXIMATE_UNARY(atan, p)                                            \
+        W_GLSW_APPROXIMATE_UNARY(exp, p)                                             \
+        W_GLSW_APPROXIMATE_UNARY(log, p)                                             \
+        inline constexpr auto atan(float a, float b)                                 \
+        {                                                                            \
+            return math::approximate::atan2<math::approximate::precision::p>(a, b);  \
+        }                                                                            \
+        inline constexpr auto pow(float a, float b)                                  \
+        {                                                                            \
+            return math::approximate::pow<math::approximate::precision::p>(a, b);    \
+        }                                                                            \
+        inline constexpr auto pow(vec2 a, vec2 b)                                    \
+        {                                                                            \
+            return vec2{pow(a.x, b.x), pow(a.y, b.y)};                               \
+        }                                                                            \
+        inline constexpr auto pow(vec3 a, vec3 b)                                    \
+        {                                                                            \
+            return vec3{pow(a.x, b.x), pow(a.y, b.y), pow(a.z, b.z)};                \
+        }                                                                            \
+        inline constexpr auto pow(vec4 a, vec4 b)                                    \
+        {                                                                            \
+            return vec4{pow(a.x, b.x), pow(a.y, b.y), pow(a.z, b.z), pow(a.w, b.w)}; \
+        }                                                                            \
+        W_GLSW_LANES_BINARY(atan)                                                    \
+        W_GLSW_LANES_BINARY(pow)                                                     \
+    }                                                                                \
+    /**/
+
+    // Cephes-like, within a few ulp of libm.
+    W_GLSW_APPROXIMATE(fast)
+    // Fewer terms, about 2^-12 relative, what GLSL ES guarantees for mediump.
+    W_GLSW_APPROXIMATE(mediump)
+
+#undef W_GLSW_APPROXIMATE
+#undef W_GLSW_APPROXIMATE_UNARY
+#undef W_GLSW_LANES_BINARY
+#undef W_GLSW_LANES_UNARY
+
+    inline constexpr auto floatBitsToUint(float a)
     {
         return std::bit_cast<uint>(a);
     }
-    inline auto floatBitsToUint(vec4 a)
+    inline constexpr auto floatBitsToUint(vec4 a)
     {
         return uvec4
         {
@@ -1496,19 +1782,19 @@ namespace w::glsw
             floatBitsToUint(a.w)
         };
     }
-    inline auto all(uvec4 a)
+    inline constexpr auto all(uvec4 a)
     {
         return a.x && a.y && a.z && a.w;
     }
-    inline auto equal(int a, int b)
+    inline constexpr auto equal(int a, int b)
     {
         return a == b;
     }
-    inline auto equal(uint a, uint b)
+    inline constexpr auto equal(uint a, uint b)
     {
         return a == b;
     }
-    inline auto equal(ivec3 a, ivec3 b)
+    inline constexpr auto equal(ivec3 a, ivec3 b)
     {
         return bvec3
         {
@@ -1517,7 +1803,7 @@ namespace w::glsw
             equal(a.z, b.z)
         };
     }
-    inline auto equal(uvec4 a, uvec4 b)
+    inline constexpr auto equal(uvec4 a, uvec4 b)
     {
         return bvec4
         {
@@ -1527,11 +1813,11 @@ namespace w::glsw
             equal(a.w, b.w)
         };
     }
-    inline auto notEqual(int a, int b)
+    inline constexpr auto notEqual(int a, int b)
     {
         return a != b;
     }
-    inline auto notEqual(ivec3 a, ivec3 b)
+    inline constexpr auto notEqual(ivec3 a, ivec3 b)
     {
         return bvec3
         {
@@ -1541,121 +1827,517 @@ namespace w::glsw
         };
     }
     
-    inline vec4 textureLod(sampler2D const & b, vec2 p, float l)
+    // Bilinear within one level, repeat wrapping, texel centres at half integers as in GL.
+    inline vec4 textureLevel(sampler2D const & b, sampler2D::level const & l, vec2 p)
     {
-        if (!std::isnormal(p.x) || !std::isnormal(p.y))
+        auto const x = fract(p.x) * float(l.width) - .5f;
+        auto const y = fract(p.y) * float(l.height) - .5f;
+        auto const fx = std::floor(x);
+        auto const fy = std::floor(y);
+        auto const tx = x - fx;
+        auto const ty = y - fy;
+
+        // fract leaves x0 in [-1, width - 1], so one wrap each way is enough.
+        auto const x0 = fx < 0 ? l.width - 1 : std::size_t(fx);
+        auto const y0 = fy < 0 ? l.height - 1 : std::size_t(fy);
+        auto const x1 = x0 + 1 == l.width ? 0 : x0 + 1;
+        auto const y1 = y0 + 1 == l.height ? 0 : y0 + 1;
+
+        auto const bottom = mix(b.texel(l, x0, y0), b.texel(l, x1, y0), tx);
+        auto const top = mix(b.texel(l, x0, y1), b.texel(l, x1, y1), tx);
+        return mix(bottom, top, ty);
+    }
+
+    // Trilinear, lod 0 is the full size level.
+    inline vec4 textureLod(sampler2D const & b, vec2 p, float lod)
+    {
+        auto const levels = b.levels();
+        if (levels.empty() || !std::isfinite(p.x) || !std::isfinite(p.y))
         {
             return vec4{};
         }
 
-        auto const width = b.width;
-        auto const height = b.height;
+        auto const l = std::clamp(std::isnan(lod) ? 0.f : lod, 0.f, float(levels.size() - 1));
+        auto const l0 = std::size_t(l);
+        auto const f = l - float(l0);
 
-        auto u = p.x;
-        auto v = p.y;
+        auto const result = textureLevel(b, levels[l0], p);
+        return f > 0.f ? mix(result, textureLevel(b, levels[l0 + 1], p), f) : result;
+    }
 
-        u = fract(u);
-        v = fract(v);
+    // There are no screen space derivatives per fragment, so the implicit level is 0 and
+    // bias alone selects the mip.
+    inline auto texture(sampler2D const & b, vec2 p, float bias = 0.f)
+    {
+        auto const result = textureLod(b, p, bias);
+        return rgb{result.x, result.y, result.z};
+    }
 
-        float x = u * (width - 1);
-        float y = v * (height - 1);
+    inline auto texture(sampler2D const & b, vec3 p, float bias = 0.f) // TODO
+    {
+        auto const result = textureLod(b, p.xy(), bias);
+        return rgb{result.x, result.y, result.z};
+    }
 
-        int x0 = static_cast<int>(std::floor(x));
-        int x1 = std::min(x0 + 1, int(width) - 1);
-        int y0 = static_cast<int>(std::floor(y));
-        int y1 = std::min(y0 + 1, int(height) - 1);
+    struct POINT
+    {
+        long x;
+        long y;
+    };
+    struct SIZE
+    {
+        long cx;
+        long cy;
+    };
+    template<typename F>
+    concept fragment_shader = std::is_same_v<std::invoke_result_t<F, vec2>, vec4>;
 
-        float tx = x - x0;
-        float ty = y - y0;
+    // What a shader needs from the host, declared in the shader namespace as
+    //     inline constexpr auto options = shader_options{.uses_iDate = false};
+    struct shader_options
+    {
+        bool uses_iDate = true;
+        bool uses_iTime = true; // false lets hosts redraw only when something else changes
+        bool srgb = false; // mainImage returns linear colour, encoded to sRGB when packed
+    };
+
+    inline constexpr auto options = shader_options{};
+
+    // Shaders without a prepare of their own get this one, and a mainImage of just fragCoord.
+    struct stateless
+    {
+    };
+
+    inline auto prepare()
+    {
+        return stateless{};
+    }
+
+    // A shader can compute whatever depends on the uniforms alone once per frame instead of
+    // once per pixel:
+    //     struct frame { vec2 spot; };
+    //     inline auto prepare() { return frame{vec2(sin(iTime), cos(iTime))}; }
+    //     inline auto mainImage(frame const & f, vec2 fragCoord) { ... }
+    // render calls prepare with the frame's uniforms bound and hands its result to every
+    // fragment. The state type is erased here, so shaders of any kind fit one list.
+    struct shader
+    {
+        vec4 (*mainImage)(vec2); // reads the state render bound next to the uniforms
+        char const * name;
+        shader_options options;
+        std::shared_ptr<void const> (*prepare)() = nullptr; // null when stateless
+        simd::vec4 (*packet)(simd::vec2 const &) = nullptr; // null without a mainImage overload for simd::vec2
+    };
 
-        auto get_texel = [&](int xi, int yi)
+    // The shader's mainImage for one fragment or a packet, with the state render bound
+    // ahead of fragCoord when there is one.
+    template<typename State, typename F>
+    auto main_image(auto const & fragCoord)
+    {
+        if constexpr (std::is_same_v<State, stateless>)
+        {
+            return F{}(fragCoord);
+        }
+        else
         {
-            yi = height - yi - 1;
-            //return vec3((xi + yi) % 2 == 1);
+            return F{}(*static_cast<State const *>(prepared_state), fragCoord);
+        }
+    }
 
-            if (xi < 0 || xi >= width || yi < 0 || yi >= height)
-            {
-                // std::println("over{}-{}", xi, yi);
-                // DebugBreak(); 
-                // abort();
-                return vec3{};
-            }
+    // What W_GLSL_SHADER_AS expands to; prepare and main_image are captureless lambdas
+    // forwarding to the shader namespace, the latter fails to substitute for arguments no
+    // mainImage takes.
+    template<typename P, typename F>
+    auto make_shader(char const * name, shader_options const & options, P, F) -> shader
+    {
+        using state = decltype(P{}());
+        auto s = shader{[](vec2 fragCoord) -> vec4 { return main_image<state, F>(fragCoord); }, name, options};
+        if constexpr (!std::is_same_v<state, stateless>)
+        {
+            s.prepare = []() -> std::shared_ptr<void const> { return std::make_shared<state const>(P{}()); };
+        }
+        if constexpr (std::is_invocable_r_v<simd::vec4, F, simd::vec2 const &> || std::is_invocable_r_v<simd::vec4, F, state const &, simd::vec2 const &>)
+        {
+            s.packet = [](simd::vec2 const & fragCoord) -> simd::vec4 { return main_image<state, F>(fragCoord); };
+        }
+        return s;
+    }
 
-            auto const i = b.data[xi + yi * width];
-            auto const r = (i >> 16) & 0xFF;
-            auto const g = (i >> 8) & 0xFF;
-            auto const b = (i >> 0) & 0xFF;
-            return vec3
-            {
-                float(r) / 255.0f, 
-                float(g) / 255.0f, 
-                float(b) / 255.0f
-            };
-        };
+    // Time stamp counter where there is one, nanoseconds otherwise. Only ever compared
+    // with itself, for relative cost.
+    inline auto cycles() -> std::uint64_t
+    {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86)) || defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    // Time spent in each tile of one frame, row-major from the bottom left tile. size is
+    // the grid that was shaded, output the area it was scaled into.
+    struct tile_profile
+    {
+        SIZE tile;
+        SIZE size;
+        SIZE output;
+        long columns;
+        long rows;
+        std::vector<std::chrono::nanoseconds> times;
+        std::vector<std::uint64_t> cycles;
+    };
+
+    // Cycles spent on each shaded fragment, row-major from the bottom left. A packet is
+    // timed as a whole and its cost split evenly among its fragments.
+    struct pixel_profile
+    {
+        SIZE size;
+        std::vector<std::uint64_t> cycles;
+    };
+
+    // Float colour planes, row-major from the bottom left. render can shade into one instead
+    // of a packed surface, pack then converts it in a separate pass.
+    class framebuffer
+    {
+        SIZE extent = {0, 0};
+        std::vector<float> data; // r, g, b and a planes back to back
+
+    public:
+        auto size() const
+        {
+            return extent;
+        }
+
+        auto resize(SIZE s)
+        {
+            extent = s;
+            data.resize(std::size_t(4 * s.cx * s.cy));
+        }
 
-        auto const c00 = get_texel(x0, y0);
-        auto const c10 = get_texel(x1, y0);
-        auto const c01 = get_texel(x0, y1);
-        auto const c11 = get_texel(x1, y1);
+        // c is 0 for red through 3 for alpha.
+        auto plane(std::size_t c) -> float *
+        {
+            return data.data() + c * std::size_t(extent.cx * extent.cy);
+        }
 
-        auto const top = mix(c00, c10, tx);
-        auto const bottom = mix(c01, c11, tx);
+        auto plane(std::size_t c) const -> float const *
+        {
+            return data.data() + c * std::size_t(extent.cx * extent.cy);
+        }
 
-        auto const result = mix(top, bottom, ty);
+        auto store(long i, long j, vec4 v)
+        {
+            auto const k = std::size_t(i * extent.cx + j);
+            plane(0)[k] = v.x;
+            plane(1)[k] = v.y;
+            plane(2)[k] = v.z;
+            plane(3)[k] = v.w;
+        }
+    };
+
+    // What render stores fragments into as floats, at the shaded size, instead of packing
+    // them: framebuffer, or anything else that can be sized and stored into like it.
+    template<typename T>
+    concept float_target = requires (T & o, SIZE s, vec4 c)
+    {
+        { o.size() } -> std::same_as<SIZE>;
+        o.resize(s);
+        o.store(0L, 0L, c);
+    };
 
-        return vec4(result, 0.f);
+    // Rounds half away from zero like std::round, but without a libm call or branches so
+    // that loops over it vectorize. m - t is exact for the values that reach it. NaN maps
+    // to 0, the same as maxps does in pack_bgra.
+    inline auto unorm8(float v) -> std::uint32_t
+    {
+        auto const m = (v > 0.f ? std::min(v, 1.f) : 0.f) * 255.f;
+        auto const t = std::int32_t(m);
+        return std::uint32_t(t + (m - float(t) >= .5f));
     }
-    inline auto texture(sampler2D const & b, vec2 p, float bias = 0.f)
+
+    // Linear to sRGB, quantized input to 8-bit output. 4096 entries keep it within one
+    // level of the exact curve even along the steep linear toe.
+    inline auto const & srgb_table()
     {
-        auto const result = textureLod(b, p, 0.f);
-        return rgb{result.x, result.y, result.z};
+        static auto const table = []
+        {
+            auto result = std::array<std::uint8_t, 4096>{};
+            for (auto i = std::size_t{}; i != result.size(); ++i)
+            {
+                auto const c = double(i) / double(result.size() - 1);
+                auto const e = c <= 0.0031308 ? 12.92 * c : 1.055 * std::pow(c, 1 / 2.4) - 0.055;
+                result[i] = std::uint8_t(std::lround(e * 255));
+            }
+            return result;
+        }();
+        return table;
     }
 
-    inline auto texture(sampler2D const & b, vec3 p, float bias = 0.f) // TODO
+    inline auto srgb8(float v) -> std::uint32_t
     {
-        auto const result = textureLod(b, p.xy(), 0.f);
-        return rgb{result.x, result.y, result.z};
+        auto const & table = srgb_table();
+        auto const c = v > 0.f ? std::min(v, 1.f) : 0.f;
+        return table[std::size_t(c * float(table.size() - 1) + .5f)];
     }
 
-    struct POINT
+    // Packs n pixels from float planes into BGRA, bit for bit what unorm8 gives per
+    // channel. Eight pixels per step with AVX2, four with SSE2, the rest one at a time.
+    inline auto pack_bgra(float const * r, float const * g, float const * b, float const * a, std::uint32_t * out, std::size_t n, std::uint32_t mask = 0)
     {
-        long x;
-        long y;
+        auto j = std::size_t{};
+
+#if defined(__AVX2__)
+        {
+            auto const zero = _mm256_setzero_ps();
+            auto const one = _mm256_set1_ps(1.f);
+            auto const k = _mm256_set1_ps(255.f);
+            auto const half = _mm256_set1_ps(.5f);
+            auto const m = _mm256_set1_epi32(int(mask));
+
+            auto const convert = [&](float const * p)
+            {
+                auto const v = _mm256_mul_ps(_mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(p), zero), one), k);
+                auto const t = _mm256_cvttps_epi32(v);
+                auto const up = _mm256_castps_si256(_mm256_cmp_ps(_mm256_sub_ps(v, _mm256_cvtepi32_ps(t)), half, _CMP_GE_OQ));
+                return _mm256_sub_epi32(t, up);
+            };
+
+            for (; j + 8 <= n; j += 8)
+            {
+                auto const c = _mm256_or_si256
+                (
+                    _mm256_or_si256(convert(b + j), _mm256_slli_epi32(convert(g + j), 8)),
+                    _mm256_or_si256(_mm256_slli_epi32(convert(r + j), 16), _mm256_slli_epi32(convert(a + j), 24))
+                );
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + j), _mm256_or_si256(c, m));
+            }
+        }
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_IX86_FP) && _M_IX86_FP >= 2
+        {
+            auto const zero = _mm_setzero_ps();
+            auto const one = _mm_set1_ps(1.f);
+            auto const k = _mm_set1_ps(255.f);
+            auto const half = _mm_set1_ps(.5f);
+            auto const m = _mm_set1_epi32(int(mask));
+
+            auto const convert = [&](float const * p)
+            {
+                auto const v = _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(p), zero), one), k);
+                auto const t = _mm_cvttps_epi32(v);
+                auto const up = _mm_castps_si128(_mm_cmpge_ps(_mm_sub_ps(v, _mm_cvtepi32_ps(t)), half));
+                return _mm_sub_epi32(t, up);
+            };
+
+            for (; j + 4 <= n; j += 4)
+            {
+                auto const c = _mm_or_si128
+                (
+                    _mm_or_si128(convert(b + j), _mm_slli_epi32(convert(g + j), 8)),
+                    _mm_or_si128(_mm_slli_epi32(convert(r + j), 16), _mm_slli_epi32(convert(a + j), 24))
+                );
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(out + j), _mm_or_si128(c, m));
+            }
+        }
+#endif
+        for (; j != n; ++j)
+        {
+            out[j] = mask | unorm8(b[j]) | (unorm8(g[j]) << 8) | (unorm8(r[j]) << 16) | (unorm8(a[j]) << 24);
+        }
+    }
+
+    struct render_options
+    {
+        bool parallel = true;
+        SIZE tile = {16, 16};
+        float scale = 1.f; // fraction of the target size actually shaded, upscaled into the output
+        tile_profile * profile = nullptr; // filled with per-tile times when set
+        pixel_profile * pixels = nullptr; // filled with per-fragment cycles when set, costs a counter read per packet
+        bool srgb = false; // encode colour, not alpha, to sRGB
+        int interleave = 1; // shade one tile in interleave per frame, the rest keep the previous frame's pixels
+        int phase = 0; // which tile of each interleave group, advance it once per frame
+        vec2 offset = vec2(.5f); // where in its pixel each fragment is shaded, moved around to jitter
     };
-    struct SIZE
+
+    struct render_stats
     {
-        long cx;
-        long cy;
+        SIZE tile;
+        std::size_t tiles;
+        std::size_t packet; // fragments per mainImage call
+        float scale;
+    };
+
+    // Chooses render_options::scale from measured frame times so that rendering
+    // stays near the target frame time. The cost of a frame is taken to be
+    // proportional to the number of shaded pixels, i.e. to scale squared.
+    class dynamic_scale
+    {
+        std::chrono::duration<double> target;
+        float minimum;
+        float value;
+
+    public:
+        explicit dynamic_scale(std::chrono::duration<double> target = std::chrono::duration<double>{1. / 30}, float minimum = .25f) :
+            target{target}, minimum{minimum}, value{1.f}
+        {
+        }
+
+        auto update(std::chrono::duration<double> frame_time)
+        {
+            if (frame_time.count() > 0)
+            {
+                auto const wanted = value * std::sqrt(float(target / frame_time));
+                // Move half way there and ignore jitter, otherwise the picture keeps pumping.
+                auto const next = std::clamp(value + (wanted - value) / 2, minimum, 1.f);
+                if (std::abs(next - value) > value / 20 || next == 1.f || next == minimum)
+                {
+                    value = next;
+                }
+            }
+            return value;
+        }
+
+        auto get() const
+        {
+            return value;
+        }
     };
-    auto render(float time, POINT p, SIZE s, auto f, auto & o, POINT mouse, bool parallel = true)
+
+    // Local time of day for iDate. The zone is resolved once and the offset between
+    // local time and steady_clock is refreshed every period, so a frame pays for one
+    // clock read instead of a zone lookup.
+    class time_of_day
     {
-        static_assert(std::is_same_v<decltype(f({float{}, float{}})), w::glsw::vec4>);
+        using clock = std::chrono::steady_clock;
 
-        w::glsw::iTime = time;
+        std::chrono::time_zone const * zone;
+        std::chrono::nanoseconds period;
+        std::atomic<std::chrono::nanoseconds::rep> offset;
+        std::atomic<std::chrono::nanoseconds::rep> refreshed_at;
 
-        auto seconds_since_midnight = []
+        static auto since_epoch(clock::time_point t)
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch());
+        }
+
+        auto refresh(clock::time_point now)
         {
             // Thanks, Howard
-            using namespace std;
             using namespace std::chrono;
 
-            auto now = current_zone()->to_local(system_clock::now());
-            auto today = floor<days>(now);
-            auto tod = duration_cast<nanoseconds>(now - today);
+            auto const local = zone->to_local(system_clock::now());
+            auto const delta = duration_cast<nanoseconds>(local.time_since_epoch()) - since_epoch(now);
+            offset.store(delta.count(), std::memory_order_relaxed);
+        }
+
+    public:
+        explicit time_of_day(std::chrono::nanoseconds period = std::chrono::minutes{1}) :
+            zone{std::chrono::current_zone()}, period{period}, offset{}, refreshed_at{}
+        {
+            auto const now = clock::now();
+            refresh(now);
+            refreshed_at = since_epoch(now).count();
+        }
+        time_of_day(time_of_day &&) = delete;
+        auto operator=(time_of_day &&) = delete;
+
+        auto seconds_since_midnight()
+        {
+            using namespace std::chrono;
+
+            auto const now = clock::now();
+            auto const n = since_epoch(now).count();
+            auto last = refreshed_at.load(std::memory_order_relaxed);
+            if (n - last > period.count() && refreshed_at.compare_exchange_strong(last, n))
+            {
+                refresh(now);
+            }
+
+            auto const local = nanoseconds{n + offset.load(std::memory_order_relaxed)};
+            auto const tod = local - floor<days>(local);
             return tod.count() / 1e9f;
+        }
+    };
+
+    inline auto default_time_of_day() -> time_of_day &
+    {
+        static auto result = time_of_day{};
+        return result;
+    }
+
+    inline auto make_uniforms(float time, POINT p, SIZE s, POINT mouse, shader_options const & needs = {})
+    {
+        auto const rel = POINT{mouse.x - p.x, mouse.y - p.y};
+
+        return uniforms
+        {
+            .iTime = time,
+            .iDate = {1970, 1, 1, needs.uses_iDate ? default_time_of_day().seconds_since_midnight() : 0.f},
+            .iMouse = {float(rel.x), float(rel.y), 0.f},
+            .iResolution = {float(s.cx), float(s.cy), 1.0}
         };
+    }
+
+    auto render(uniforms const & u, POINT p, SIZE s, auto f, auto & o, render_options const & options = {})
+    {
+        constexpr auto described = std::is_same_v<decltype(f), shader>;
+        static_assert(described || fragment_shader<decltype(f)>);
+
+        // With a scale below one the shader runs on a smaller grid, every shaded
+        // fragment then fills a block of output pixels.
+        auto const scale = std::clamp(options.scale, 0.f, 1.f);
+        auto const r = scale == 1.f || s.cx <= 0 || s.cy <= 0 ? s : SIZE
+        {
+            std::max(std::lround(s.cx * scale), 1L),
+            std::max(std::lround(s.cy * scale), 1L)
+        };
+        auto const scaled = r.cx != s.cx || r.cy != s.cy;
 
-        w::glsw::iDate = {1970, 1, 1, seconds_since_midnight()};
-        w::glsw::iResolution = w::glsw::vec3{float(s.cx), float(s.cy), 1.0};
+        auto su = u;
+        if (scaled)
         {
-            auto const rel = POINT{mouse.x - p.x, mouse.y - p.y};
-            w::glsw::iMouse = {float(rel.x), float(rel.y), 0.f};
+            auto const k = vec3{float(r.cx) / float(s.cx), float(r.cy) / float(s.cy), 1.f};
+            su.iResolution *= k;
+            su.iMouse *= k;
         }
 
-        auto const write = [&](auto i, auto j)
+        // Once per frame with the uniforms the fragments see, on this thread. The state
+        // outlives every tile, the parallel loops below only return once they are done.
+        auto state = std::shared_ptr<void const>{};
+        if constexpr (described)
+        {
+            if (f.prepare)
+            {
+                auto const bound = scoped_uniforms{su};
+                state = f.prepare();
+            }
+            su.state = state.get();
+        }
+        auto const function = [&]
+        {
+            if constexpr (described)
+            {
+                return f.mainImage;
+            }
+            else
+            {
+                return f;
+            }
+        }();
+        auto const packet = [&]
         {
-            auto c = f({j + 0.5f, i + 0.5f});
+            if constexpr (described)
+            {
+                return f.packet;
+            }
+            else
+            {
+                return decltype(shader::packet){};
+            }
+        }();
 
+        auto const write = [&](auto i, auto j, vec4 c)
+        {
             /* if (std::isnan(c.x) || std::isnan(c.y) || std::isnan(c.z) || std::isnan(c.w))
             {
                 c = {1.f};
@@ -1663,42 +2345,223 @@ namespace w::glsw
                 std::abort();
             } */
 
-            auto get = [](auto v)
+            if constexpr (float_target<std::remove_cvref_t<decltype(o)>>)
             {
-                auto const c = std::clamp(v, 0.f, 1.f);
-                auto const m = c * 255.f;
-                auto const r = std::uint32_t(std::round(m));
-                return r;
-            };
-            auto const rgba = get(c.z) + (get(c.y) << 8) + (get(c.x) << 16) + (get(c.w) << 24);
-            o[i + p.y, j + p.x] = rgba;
+                o.store(i, j, c);
+            }
+            else
+            {
+                auto const rgba = options.srgb ?
+                    srgb8(c.z) + (srgb8(c.y) << 8) + (srgb8(c.x) << 16) + (unorm8(c.w) << 24) :
+                    unorm8(c.z) + (unorm8(c.y) << 8) + (unorm8(c.x) << 16) + (unorm8(c.w) << 24);
+                if (scaled)
+                {
+                    for (auto y = i * s.cy / r.cy, e = (i + 1) * s.cy / r.cy; y != e; ++y)
+                    {
+                        for (auto x = j * s.cx / r.cx, e = (j + 1) * s.cx / r.cx; x != e; ++x)
+                        {
+                            o[y + p.y, x + p.x] = rgba;
+                        }
+                    }
+                }
+                else
+                {
+                    o[i + p.y, j + p.x] = rgba;
+                }
+            }
         };
 
-        if (parallel)
+        // n fragments of row i from column j, at most a packet. The packet overload gets all of
+        // them in lanes, the tail packet repeating its last fragment so that no lane is garbage.
+        auto const shade = [&](long i, long j, long n)
         {
-            auto const v = std::views::iota(long{}, s.cy * s.cx);
-            std::for_each
-            (
-                std::execution::par_unseq,
-                v.begin(), v.end(),
-                [&](auto v)
+            if (packet)
+            {
+                auto in = simd::vec2{0.f, i + options.offset.y};
+                for (auto k = long{}; k != long(simd::width); ++k)
                 {
-                    auto const i = v / s.cx;
-                    auto const j = v % s.cx;
+                    in.x[k] = j + std::min(k, n - 1) + options.offset.x;
+                }
+                auto const c = packet(in);
+                for (auto k = long{}; k != n; ++k)
+                {
+                    write(i, j + k, {c.x[k], c.y[k], c.z[k], c.w[k]});
+                }
+            }
+            else
+            {
+                for (auto k = long{}; k != n; ++k)
+                {
+                    write(i, j + k, function(vec2{j + k + options.offset.x, i + options.offset.y}));
+                }
+            }
+        };
 
-                    write(i, j);
+        auto const write_row = [&](long i, long left, long right)
+        {
+            for (auto j = left; j < right; j += long(simd::width))
+            {
+                auto const n = std::min(long(simd::width), right - j);
+                if (options.pixels)
+                {
+                    auto const b = cycles();
+                    shade(i, j, n);
+                    auto const c = (cycles() - b) / std::uint64_t(n);
+                    std::fill_n(options.pixels->cycles.begin() + (i * r.cx + j), n, c);
                 }
-            );
+                else
+                {
+                    shade(i, j, n);
+                }
+            }
+        };
+
+        // Workers get whole tiles, so each one writes its own run of cache lines per row
+        // instead of interleaving single pixels with its neighbours.
+        auto const t = SIZE{std::max(options.tile.cx, 1L), std::max(options.tile.cy, 1L)};
+        auto const columns = (r.cx + t.cx - 1) / t.cx;
+        auto const rows = (r.cy + t.cy - 1) / t.cy;
+
+        if (options.profile)
+        {
+            *options.profile = {t, r, s, columns, rows, {}, {}};
+            options.profile->times.resize(std::size_t(rows * columns));
+            options.profile->cycles.resize(std::size_t(rows * columns));
+        }
+        if (options.pixels)
+        {
+            *options.pixels = {r, std::vector<std::uint64_t>(std::size_t(r.cx * r.cy))};
+        }
+        // Skipped tiles show whatever o held before, so a target that has nothing to reuse gets
+        // every tile. Hosts drawing into their own surface pass interleave 1 after a resize.
+        auto interleave = std::max(options.interleave, 1);
+        if constexpr (float_target<std::remove_cvref_t<decltype(o)>>)
+        {
+            if (o.size().cx != r.cx || o.size().cy != r.cy)
+            {
+                interleave = 1;
+            }
+            o.resize(r); // only the shaded grid, pack scales it to the output
+        }
+
+        auto const write_tile = [&](long k)
+        {
+            // column + 3 * row spreads the shaded tiles diagonally, a checkerboard for 2.
+            if ((k % columns + 3 * (k / columns) + options.phase) % interleave != 0)
+            {
+                return;
+            }
+
+            auto const bound = scoped_uniforms{su};
+            auto const b = options.profile ? now() : decltype(now()){};
+            auto const bc = options.profile ? cycles() : 0;
+
+            auto const top = k / columns * t.cy;
+            auto const left = k % columns * t.cx;
+            auto const bottom = std::min(top + t.cy, r.cy);
+            auto const right = std::min(left + t.cx, r.cx);
+
+            for (auto i = top; i != bottom; ++i)
+            {
+                write_row(i, left, right);
+            }
+
+            if (options.profile)
+            {
+                options.profile->times[k] = now() - b;
+                options.profile->cycles[k] = cycles() - bc;
+            }
+        };
+
+        auto const v = std::views::iota(long{}, rows * columns);
+        if (options.parallel)
+        {
+            std::for_each(std::execution::par, v.begin(), v.end(), write_tile);
         }
         else
         {
-            for (auto i = 0; i != s.cy; ++i)
+            std::for_each(v.begin(), v.end(), write_tile);
+        }
+
+        return render_stats{t, std::size_t(rows * columns), packet ? simd::width : 1, float(r.cx) / float(s.cx)};
+    }
+
+    // Same with colour encoded through srgb_table, a lookup per channel.
+    inline auto pack_bgra_srgb(float const * r, float const * g, float const * b, float const * a, std::uint32_t * out, std::size_t n, std::uint32_t mask = 0)
+    {
+        for (auto j = std::size_t{}; j != n; ++j)
+        {
+            out[j] = mask | srgb8(b[j]) | (srgb8(g[j]) << 8) | (srgb8(r[j]) << 16) | (unorm8(a[j]) << 24);
+        }
+    }
+
+    struct pack_options
+    {
+        std::uint32_t mask = 0; // ORed into every pixel, 0xff000000 makes it opaque
+        bool srgb = false;
+        bool parallel = true;
+    };
+
+    // Converts a framebuffer to packed BGRA, scaling it up to s when it was shaded at a lower
+    // render_options::scale. row(i) returns the first pixel of output row i, counted from the
+    // bottom, so flipping or striding is up to the host.
+    inline auto pack(framebuffer const & fb, SIZE s, auto row, pack_options const & options = {})
+    {
+        auto const r = fb.size();
+        auto const scaled = r.cx != s.cx || r.cy != s.cy;
+        auto const red = fb.plane(0);
+        auto const green = fb.plane(1);
+        auto const blue = fb.plane(2);
+        auto const alpha = fb.plane(3);
+
+        auto const pack_row = [&](long i, std::uint32_t * out)
+        {
+            auto const k = std::size_t(i * r.cx);
+            (options.srgb ? pack_bgra_srgb : pack_bgra)(red + k, green + k, blue + k, alpha + k, out, std::size_t(r.cx), options.mask);
+        };
+
+        auto const write_row = [&](long i)
+        {
+            if (!scaled)
             {
-                for (auto j = 0; j != s.cx; ++j)
-                {
-                    write(i, j);
-                }
+                pack_row(i, row(i));
+                return;
             }
+
+            thread_local auto packed = std::vector<std::uint32_t>{};
+            packed.resize(std::size_t(r.cx));
+            pack_row(i, packed.data());
+
+            auto const first = row(i * s.cy / r.cy);
+            for (auto j = 0l; j != r.cx; ++j)
+            {
+                std::fill(first + j * s.cx / r.cx, first + (j + 1) * s.cx / r.cx, packed[j]);
+            }
+            for (auto y = i * s.cy / r.cy + 1, e = (i + 1) * s.cy / r.cy; y < e; ++y)
+            {
+                std::copy_n(first, s.cx, row(y));
+            }
+        };
+
+        auto const v = std::views::iota(long{}, r.cy);
+        if (options.parallel)
+        {
+            std::for_each(std::execution::par, v.begin(), v.end(), write_row);
+        }
+        else
+        {
+            std::for_each(v.begin(), v.end(), write_row);
         }
     }
+
+    auto render(float time, POINT p, SIZE s, auto f, auto & o, POINT mouse, render_options const & options = {})
+    {
+        return render(make_uniforms(time, p, s, mouse), p, s, f, o, options);
+    }
+
+    auto render(float time, POINT p, SIZE s, shader const & f, auto & o, POINT mouse, render_options options = {})
+    {
+        options.srgb = options.srgb || f.options.srgb;
+        return render(make_uniforms(time, p, s, mouse, f.options), p, s, f, o, options);
+    }
 }
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <w/glsw.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <execution>
+#include <ranges>
+
+// Progressive multi-sampling for stills. Every render shades one more sample per pixel, at
+// its own position within the pixel and moment within the shutter, and folds it into a
+// running mean that hosts show while it converges:
+//
+//     if (!hq.done())
+//     {
+//         hq.render(time, p, s, shader, mouse);
+//         pack(hq.image(), s, row);
+//     }
+namespace w::glsw
+{
+    // Element i of the Halton sequence in base b, spread evenly over [0, 1) for any prefix.
+    inline auto halton(unsigned i, unsigned b)
+    {
+        auto f = 1.f;
+        auto result = 0.f;
+        for (; i; i /= b)
+        {
+            f /= float(b);
+            result += f * float(i % b);
+        }
+        return result;
+    }
+
+    class accumulator
+    {
+        framebuffer mean;
+        framebuffer sample;
+        int count = 0;
+        int target;
+
+    public:
+        float shutter = 0; // seconds each sample's time is spread over, for motion blur
+
+        explicit accumulator(int samples = 64) : target{std::max(samples, 1)}
+        {
+        }
+
+        // Starts over, the next render is sample 1.
+        auto reset(int samples)
+        {
+            target = std::max(samples, 1);
+            count = 0;
+        }
+
+        auto samples() const
+        {
+            return count;
+        }
+
+        auto wanted() const
+        {
+            return target;
+        }
+
+        auto done() const
+        {
+            return count >= target;
+        }
+
+        auto image() const -> framebuffer const &
+        {
+            return mean;
+        }
+
+        // Shades the next sample of program at time and adds it to image(), starting over
+        // when s changed. The first sample is at the pixel centres and at time itself, so
+        // it is the interactive frame. Samples are shaded in full at scale 1, whatever
+        // options says.
+        auto render(float time, POINT p, SIZE s, auto & program, POINT mouse, render_options options = {})
+        {
+            if (mean.size().cx != s.cx || mean.size().cy != s.cy)
+            {
+                mean.resize(s);
+                count = 0;
+            }
+            if (done())
+            {
+                return render_stats{options.tile, 0, 1, 1.f};
+            }
+
+            auto const k = unsigned(count);
+            options.scale = 1.f;
+            options.interleave = 1;
+            options.offset = k ? vec2{halton(k, 2), halton(k, 3)} : vec2(.5f);
+            auto const t = time + (k ? shutter * halton(k, 5) : 0.f);
+
+            auto const stats = w::glsw::render(t, p, s, program, sample, mouse, options);
+
+            // Running mean, so that image() is always the average of what was shaded so far.
+            auto const weight = 1.f / float(++count);
+            auto const n = std::size_t(4 * s.cx * s.cy); // every plane, they are back to back
+            auto const m = mean.plane(0);
+            auto const x = sample.plane(0);
+            auto const v = std::views::iota(std::size_t{}, n);
+            std::for_each
+            (
+                std::execution::par_unseq, v.begin(), v.end(),
+                [=](std::size_t i)
+                {
+                    m[i] += (x[i] - m[i]) * weight;
+                }
+            );
+
+            return stats;
+        }
+    };
+}
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <w/glsw.hpp>
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Shadertoy style multi-pass rendering. Every pass but the last renders into a buffer that
+// later passes sample in the same frame and every pass, itself included, samples as it was
+// the frame before. The last pass draws the image.
+namespace w::glsw
+{
+    struct channel_input
+    {
+        enum class source
+        {
+            none,
+            texture, // channel_textures[index]
+            buffer   // the output of pass index
+        };
+
+        source from = source::none;
+        std::size_t index = 0;
+    };
+
+    inline auto texture_input(std::size_t i)
+    {
+        return channel_input{channel_input::source::texture, i};
+    }
+
+    inline auto buffer_input(std::size_t i)
+    {
+        return channel_input{channel_input::source::buffer, i};
+    }
+
+    struct pass
+    {
+        shader program;
+        std::array<channel_input, 4> channels = {};
+    };
+
+    // Where render writes a buffer pass: straight into the texels of a sampler2D, whose
+    // linear rows run from the bottom like fragment coordinates.
+    class sampler_target
+    {
+        sampler2D & sampler;
+        std::span<vec4> texels;
+
+    public:
+        explicit sampler_target(sampler2D & s) : sampler{s}
+        {
+        }
+
+        auto size() const
+        {
+            return SIZE{long(sampler.width()), long(sampler.height())};
+        }
+
+        auto resize(SIZE s)
+        {
+            texels = sampler.assign(std::size_t(s.cx), std::size_t(s.cy));
+        }
+
+        auto store(long i, long j, vec4 c)
+        {
+            texels[std::size_t(i) * sampler.width() + std::size_t(j)] = c;
+        }
+    };
+
+    class pipeline
+    {
+        std::vector<pass> passes;
+        std::string title;
+
+        // Two buffers per pass, written on alternating frames, so a pass reading its own
+        // output gets last frame's while it writes this frame's. Allocated once and
+        // reassigned in place as long as the size stays.
+        std::unique_ptr<std::array<sampler2D, 2>[]> buffers;
+        sampler2D empty;
+        int frame = 0;
+
+        auto bind(std::size_t current, std::array<channel_input, 4> const & channels)
+        {
+            auto result = std::array<sampler2D *, 4>{};
+            for (auto c = std::size_t{}; c != channels.size(); ++c)
+            {
+                auto const [from, i] = channels[c];
+                result[c] =
+                    from == channel_input::source::texture ? &channel_textures[i] :
+                    from == channel_input::source::buffer ? &buffers[i][(frame + (i < current ? 0 : 1)) & 1] :
+                    &empty;
+            }
+            return result;
+        }
+
+    public:
+        explicit pipeline(std::vector<pass> p, std::string name = {}) :
+            passes{std::move(p)},
+            title{name.empty() && !passes.empty() ? passes.back().program.name : std::move(name)},
+            buffers{std::make_unique<std::array<sampler2D, 2>[]>(passes.size())}
+        {
+            for (auto const & pass : passes)
+            {
+                for (auto const & [from, i] : pass.channels)
+                {
+                    if ((from == channel_input::source::texture && i >= channel_textures.size()) || (from == channel_input::source::buffer && i >= passes.size()))
+                    {
+                        throw std::out_of_range("pipeline: channel input " + std::to_string(i) + " doesn't exist");
+                    }
+                }
+            }
+        }
+
+        auto name() const -> char const *
+        {
+            return title.c_str();
+        }
+
+        // Those of the image pass, which is what the host sees.
+        auto options() const
+        {
+            return passes.empty() ? shader_options{} : passes.back().program.options;
+        }
+
+        // Like render for a single shader. Each pass is its own parallel render, which only
+        // returns once every tile is done, so passes are separated by full barriers.
+        // Buffers are shaded at full size and in full, options.scale and options.interleave
+        // apply to the image pass only.
+        auto render(float time, POINT p, SIZE s, auto & o, POINT mouse, render_options options = {})
+        {
+            auto buffer_options = options;
+            buffer_options.scale = 1.f;
+            buffer_options.interleave = 1;
+            buffer_options.profile = nullptr;
+            buffer_options.pixels = nullptr;
+
+            auto stats = render_stats{};
+            for (auto i = std::size_t{}; i != passes.size(); ++i)
+            {
+                auto const & [program, channels] = passes[i];
+
+                auto u = make_uniforms(time, p, s, mouse, program.options);
+                u.iFrame = frame;
+                u.iChannel = bind(i, channels);
+
+                if (i + 1 != passes.size())
+                {
+                    auto target = sampler_target{buffers[i][frame & 1]};
+                    w::glsw::render(u, p, s, program, target, buffer_options);
+                }
+                else
+                {
+                    options.srgb = options.srgb || program.options.srgb;
+                    stats = w::glsw::render(u, p, s, program, o, options);
+                }
+            }
+
+            ++frame;
+            return stats;
+        }
+    };
+
+    inline auto render(float time, POINT p, SIZE s, pipeline & f, auto & o, POINT mouse, render_options const & options = {})
+    {
+        return f.render(time, p, s, o, mouse, options);
+    }
+}
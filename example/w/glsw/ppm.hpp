@@ -0,0 +1,122 @@
+#pragma once
+
+#include <w/glsw.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace w::glsw
+{
+    // Decodes a binary PPM (P6), 8 or 16 bits per channel, straight from the file bytes
+    // into the sampler. Alpha is opaque.
+    inline auto load_ppm(sampler2D & s, std::span<std::byte const> file, texel_layout layout = texel_layout::linear)
+    {
+        auto i = std::size_t{};
+
+        auto const skip_space = [&]
+        {
+            while (i != file.size())
+            {
+                auto const c = char(file[i]);
+                if (c == '#')
+                {
+                    while (i != file.size() && char(file[i]) != '\n')
+                    {
+                        ++i;
+                    }
+                }
+                else if (c == ' ' || c == '\t' || c == '\r' || c == '\n')
+                {
+                    ++i;
+                }
+                else
+                {
+                    break;
+                }
+            }
+        };
+
+        // Header numbers past 2^24 are no image this could hold anyway, rejecting them keeps
+        // the arithmetic below from wrapping.
+        auto const number = [&]
+        {
+            skip_space();
+            auto result = std::size_t{};
+            auto const b = i;
+            for (; i != file.size() && char(file[i]) >= '0' && char(file[i]) <= '9'; ++i)
+            {
+                result = result * 10 + std::size_t(char(file[i]) - '0');
+                if (result > std::size_t{1} << 24)
+                {
+                    throw std::runtime_error("PPM: bad header");
+                }
+            }
+            return i != b ? result : throw std::runtime_error("PPM: bad header");
+        };
+
+        if (file.size() < 2 || char(file[0]) != 'P' || char(file[1]) != '6')
+        {
+            throw std::runtime_error("PPM: only binary P6 is supported");
+        }
+        i = 2;
+
+        auto const width = number();
+        auto const height = number();
+        auto const maxval = number();
+        ++i; // the single whitespace before the raster
+
+        auto const wide = maxval > 255;
+        auto const bytes = std::size_t{wide ? 6u : 3u};
+        if (!width || !height || !maxval || maxval > 65535 || i > file.size() || (file.size() - i) / bytes / width < height)
+        {
+            throw std::runtime_error("PPM: bad size");
+        }
+
+        auto const raster = file.subspan(i);
+        auto const scale = 1.f / float(maxval);
+
+        s.assign
+        (
+            width, height,
+            [=](std::size_t x, std::size_t y)
+            {
+                auto const p = raster.data() + (y * width + x) * bytes;
+                auto const channel = [&](std::size_t c)
+                {
+                    return wide ?
+                        float(std::uint32_t(p[2 * c]) << 8 | std::uint32_t(p[2 * c + 1])) * scale :
+                        float(p[c]) * scale;
+                };
+                return vec4{channel(0), channel(1), channel(2), 1.f};
+            },
+            layout
+        );
+    }
+
+    // Writes the framebuffer as an 8 bit P6, top row first, encoding colour to sRGB if
+    // asked to like pack does. Alpha is dropped.
+    inline auto save_ppm(std::ostream & o, framebuffer const & fb, bool srgb = false)
+    {
+        auto const s = fb.size();
+        o << "P6\n" << s.cx << " " << s.cy << "\n255\n";
+
+        auto const encode = srgb ? srgb8 : unorm8;
+        auto row = std::vector<char>(std::size_t(3 * s.cx));
+        for (auto i = s.cy; i-- > 0;)
+        {
+            for (auto j = 0l; j != s.cx; ++j)
+            {
+                auto const k = std::size_t(i * s.cx + j);
+                for (auto c = std::size_t{}; c != 3; ++c)
+                {
+                    row[3 * std::size_t(j) + c] = char(encode(fb.plane(c)[k]));
+                }
+            }
+            o.write(row.data(), std::streamsize(row.size()));
+        }
+    }
+}
@@ -0,0 +1,263 @@
+#pragma once
+
+#include <w/glsw.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <limits>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <cmath>
+
+namespace w::glsw
+{
+    // Rolling frame times of one shader.
+    class frame_history
+    {
+        static constexpr auto capacity = std::size_t{120};
+
+        std::vector<std::chrono::nanoseconds> samples; // ring buffer, oldest at next once full
+        std::size_t next = 0;
+
+    public:
+        // Bucket widths double, the first one holds frames under a millisecond and the last
+        // everything from 64 ms on.
+        static constexpr auto buckets = std::size_t{8};
+
+        auto add(std::chrono::nanoseconds t)
+        {
+            if (samples.size() < capacity)
+            {
+                samples.push_back(t);
+            }
+            else
+            {
+                samples[next] = t;
+            }
+            next = (next + 1) % capacity;
+        }
+
+        auto empty() const
+        {
+            return samples.empty();
+        }
+
+        auto percentile(double p) const -> std::chrono::nanoseconds
+        {
+            if (samples.empty())
+            {
+                return {};
+            }
+            auto sorted = samples;
+            auto const i = std::min(std::size_t(p * sorted.size()), sorted.size() - 1);
+            std::ranges::nth_element(sorted, sorted.begin() + i);
+            return sorted[i];
+        }
+
+        auto histogram() const
+        {
+            auto result = std::array<unsigned, buckets>{};
+            for (auto const t : samples)
+            {
+                auto b = std::size_t{};
+                for (auto limit = std::chrono::nanoseconds{std::chrono::milliseconds{1}}; b + 1 < buckets && t >= limit; limit *= 2)
+                {
+                    ++b;
+                }
+                ++result[b];
+            }
+            return result;
+        }
+    };
+
+    // Frame times and the last tile profile of every shader. Rendering threads record, the
+    // GUI thread toggles and reads, hence the lock.
+    class profiler
+    {
+        mutable std::mutex mutex;
+        std::vector<std::pair<frame_history, tile_profile>> shaders;
+        std::atomic<bool> on = false;
+
+    public:
+        explicit profiler(std::size_t shader_count) : shaders(shader_count)
+        {
+        }
+
+        auto enabled() const
+        {
+            return on.load();
+        }
+
+        auto toggle()
+        {
+            on = !on;
+        }
+
+        auto record(std::size_t shader, std::chrono::nanoseconds frame, tile_profile tiles)
+        {
+            auto const lock = std::lock_guard{mutex};
+            shaders[shader].first.add(frame);
+            shaders[shader].second = std::move(tiles);
+        }
+
+        auto get(std::size_t shader) const
+        {
+            auto const lock = std::lock_guard{mutex};
+            return shaders[shader];
+        }
+
+        auto summary(std::size_t shader) const
+        {
+            auto const h = get(shader).first;
+            auto const ms = [](auto t) { return std::chrono::duration<double, std::milli>{t}.count(); };
+
+            auto result = std::ostringstream{};
+            result << std::fixed << std::setprecision(1) << "p50: " << ms(h.percentile(.5)) << "ms p99: " << ms(h.percentile(.99)) << "ms";
+            return result.str();
+        }
+    };
+
+    // Tints every tile red in proportion to its share of the slowest tile and draws the frame
+    // time histogram as bars along the bottom left. Same placement as render, but o[y, x]
+    // must return a writable reference to the packed pixel.
+    inline auto draw_profile(POINT p, tile_profile const & tiles, frame_history const & history, auto & o)
+    {
+        auto const blend = [](std::uint32_t c, std::uint32_t to, unsigned a) // a in [0, 256]
+        {
+            auto result = std::uint32_t{};
+            for (auto shift = 0; shift != 32; shift += 8)
+            {
+                auto const x = (c >> shift) & 0xff;
+                auto const y = (to >> shift) & 0xff;
+                result |= ((x * (256 - a) + y * a) >> 8) << shift;
+            }
+            return result;
+        };
+
+        auto const & [t, r, s, columns, rows, times, cycles] = tiles;
+        auto const slowest = times.empty() ? std::chrono::nanoseconds{} : std::ranges::max(times);
+
+        if (slowest.count())
+        {
+            for (auto k = 0l; k != rows * columns; ++k)
+            {
+                auto const a = unsigned(128 * times[k].count() / slowest.count());
+
+                auto const top = k / columns * t.cy * s.cy / r.cy;
+                auto const left = k % columns * t.cx * s.cx / r.cx;
+                auto const bottom = std::min((k / columns + 1) * t.cy * s.cy / r.cy, s.cy);
+                auto const right = std::min((k % columns + 1) * t.cx * s.cx / r.cx, s.cx);
+
+                for (auto i = top; i != bottom; ++i)
+                {
+                    for (auto j = left; j != right; ++j)
+                    {
+                        auto & c = o[i + p.y, j + p.x];
+                        c = blend(c, 0xffff0000, a);
+                    }
+                }
+            }
+        }
+
+        auto const bars = history.histogram();
+        auto const highest = std::ranges::max(bars);
+        auto const bar = SIZE{std::max(s.cx / 4 / long(bars.size()), 1l), std::max(s.cy / 4, 1l)};
+
+        for (auto b = std::size_t{}; highest && b != bars.size(); ++b)
+        {
+            auto const height = bars[b] * bar.cy / highest;
+            for (auto i = 0l; i != height; ++i)
+            {
+                for (auto j = long(b) * bar.cx; j != long(b + 1) * bar.cx - 1 && j < s.cx; ++j)
+                {
+                    auto & c = o[i + p.y, j + p.x];
+                    c = blend(c, 0xffffffff, 192);
+                }
+            }
+        }
+    }
+
+    // One line per tile, x and y of its bottom left fragment in the shaded grid.
+    inline auto write_csv(std::ostream & o, tile_profile const & tiles)
+    {
+        auto const & [t, r, s, columns, rows, times, cycles] = tiles;
+
+        o << "row,column,x,y,width,height,ns,cycles\n";
+        for (auto k = 0l; k != long(cycles.size()); ++k)
+        {
+            auto const y = k / columns * t.cy;
+            auto const x = k % columns * t.cx;
+            o
+                << k / columns << "," << k % columns << ","
+                << x << "," << y << ","
+                << std::min(t.cx, r.cx - x) << "," << std::min(t.cy, r.cy - y) << ","
+                << times[k].count() << "," << cycles[k] << "\n";
+        }
+    }
+
+    // One line per row of fragments, top row first like the image.
+    inline auto write_csv(std::ostream & o, pixel_profile const & pixels)
+    {
+        auto const [w, h] = pixels.size;
+        for (auto i = h - 1; i >= 0; --i)
+        {
+            for (auto j = 0l; j != w; ++j)
+            {
+                o << (j ? "," : "") << pixels.cycles[i * w + j];
+            }
+            o << "\n";
+        }
+    }
+
+    // Binary PPM. Cost is mapped logarithmically from blue for the cheapest fragment over
+    // cyan, green and yellow to red for the most expensive one.
+    inline auto write_heat_map(std::ostream & o, pixel_profile const & pixels)
+    {
+        auto const [w, h] = pixels.size;
+
+        auto lo = std::numeric_limits<std::uint64_t>::max();
+        auto hi = std::uint64_t{1};
+        for (auto const c : pixels.cycles)
+        {
+            lo = c ? std::min(lo, c) : lo;
+            hi = std::max(hi, c);
+        }
+        lo = std::min(lo, hi);
+        auto const range = std::log(double(hi) / double(lo));
+
+        auto const colour = [&](std::uint64_t c)
+        {
+            auto const v = range > 0 ? std::clamp(std::log(double(std::max(c, lo)) / double(lo)) / range, 0., 1.) : 0.;
+            auto const stops = std::array<std::array<double, 3>, 5>{{{0, 0, 255}, {0, 255, 255}, {0, 255, 0}, {255, 255, 0}, {255, 0, 0}}};
+            auto const x = v * (stops.size() - 1);
+            auto const k = std::min(std::size_t(x), stops.size() - 2);
+            auto const f = x - double(k);
+
+            auto result = std::array<char, 3>{};
+            for (auto i = 0; i != 3; ++i)
+            {
+                result[i] = char(std::lround(stops[k][i] + (stops[k + 1][i] - stops[k][i]) * f));
+            }
+            return result;
+        };
+
+        o << "P6\n" << w << " " << h << "\n255\n";
+        for (auto i = h - 1; i >= 0; --i)
+        {
+            for (auto j = 0l; j != w; ++j)
+            {
+                auto const c = colour(pixels.cycles[i * w + j]);
+                o.write(c.data(), c.size());
+            }
+        }
+    }
+}
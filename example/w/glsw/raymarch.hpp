@@ -0,0 +1,363 @@
+#pragma once
+
+#include <w/glsw.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// Sphere tracing for shaders that march a distance field, counting what it costs:
+//
+//     auto const hit = raymarch::march(ro, rd, [](vec3 p) { return map(p); }, {.far = 64});
+//
+// The field may return a float or a vec2 with the distance in x, like the (distance,
+// material) pairs Shadertoy shaders use; result::value has whatever it returned last.
+namespace w::glsw::raymarch
+{
+    struct settings
+    {
+        int steps = 128; // per ray, fewer once step_budget runs dry
+        float epsilon = 1e-3f; // a hit once the field is closer than this
+        float far = 64; // a miss once the ray is further than this
+        float relaxation = 1; // steps this much further than the field allows, 1.2 to 1.6 suits smooth fields
+        bool inside = false; // a negative distance is a hit too, as loops testing d < epsilon have it
+    };
+
+    template <typename T>
+    struct result
+    {
+        float t; // to the hit, otherwise as far as the ray got, beyond settings::far once past it
+        T value; // of the field there
+        int steps;
+        bool hit; // false for a miss and for running out of steps
+    };
+
+    struct counters
+    {
+        std::uint64_t rays = 0;
+        std::uint64_t steps = 0;
+        std::uint64_t hits = 0;
+        std::uint64_t starved = 0; // rays that got fewer steps because the budget ran dry
+        int max = 0; // steps of the longest ray
+
+        auto average() const
+        {
+            return rays ? double(steps) / double(rays) : 0.;
+        }
+    };
+
+    // Every thread counts on its own and registers its counters once, so that march never
+    // touches memory another thread writes.
+    class statistics
+    {
+        std::mutex mutex;
+        std::vector<std::shared_ptr<counters>> threads;
+
+    public:
+        auto local() -> counters &
+        {
+            thread_local auto const c = [this]
+            {
+                auto result = std::make_shared<counters>();
+                auto const lock = std::lock_guard{mutex};
+                threads.push_back(result);
+                return result;
+            }();
+            return *c;
+        }
+
+        // Sums and clears what every thread counted since the last call. Only between
+        // frames, while no render is running.
+        auto collect() -> counters
+        {
+            auto const lock = std::lock_guard{mutex};
+            auto result = counters{};
+            for (auto const & c : threads)
+            {
+                result.rays += c->rays;
+                result.steps += c->steps;
+                result.hits += c->hits;
+                result.starved += c->starved;
+                result.max = std::max(result.max, c->max);
+                *c = {};
+            }
+            return result;
+        }
+    };
+
+    inline auto stats = statistics{};
+
+    // Steps all the rays of a frame share. Threads take them in chunks so that rays don't
+    // contend on one counter; once the pool is dry each ray gets fallback steps, which
+    // degrades the last tiles of a frame instead of missing the frame time.
+    class budget
+    {
+        static constexpr auto chunk = std::int64_t{4096};
+
+        std::atomic<std::int64_t> remaining{std::numeric_limits<std::int64_t>::max()};
+        std::atomic<std::uint64_t> epoch{};
+
+        struct allowance
+        {
+            std::uint64_t epoch = ~std::uint64_t{};
+            std::int64_t steps = 0;
+        };
+
+        static auto local() -> allowance &
+        {
+            thread_local auto a = allowance{};
+            return a;
+        }
+
+    public:
+        int fallback = 16;
+
+        // Between frames, like statistics::collect.
+        auto reset(std::int64_t steps = std::numeric_limits<std::int64_t>::max())
+        {
+            remaining = steps;
+            ++epoch;
+        }
+
+        // How many of the steps wanted a ray may take.
+        auto allow(int wanted) -> int
+        {
+            auto & a = local();
+            if (auto const e = epoch.load(std::memory_order_relaxed); a.epoch != e)
+            {
+                a = {e, 0};
+            }
+            if (a.steps < wanted && remaining.load(std::memory_order_relaxed) > 0)
+            {
+                auto const n = std::max(chunk, std::int64_t(wanted));
+                auto const had = remaining.fetch_sub(n, std::memory_order_relaxed);
+                a.steps += std::clamp(had, std::int64_t{}, n);
+            }
+            return a.steps >= wanted ? wanted : std::min(wanted, std::max(fallback, int(a.steps)));
+        }
+
+        auto spend(int steps)
+        {
+            local().steps -= steps;
+        }
+    };
+
+    inline auto step_budget = budget{};
+
+    // Spheres a ray proved empty, reused by the next ray this thread marches. Where a new ray
+    // passes through a chain of them that starts at its origin, it can start at the end of
+    // the chain, wherever the previous ray came from. That is exact, not a guess, but only
+    // while the field stays the same, so it forgets everything when the uniforms change.
+    // Neighbouring pixels of a tile run on the same thread one after the other, which is
+    // what makes the chains long.
+    class coherence
+    {
+        std::uint64_t generation = ~std::uint64_t{};
+        std::vector<vec4> spheres; // centre and radius
+        std::vector<vec4> next;
+
+    public:
+        // How far along rd, which must be normalized, the field is known to be empty.
+        auto begin(vec3 ro, vec3 rd) -> float
+        {
+            next.clear();
+            if (generation != uniforms_generation)
+            {
+                generation = uniforms_generation;
+                spheres.clear();
+            }
+
+            auto t = 0.f;
+            for (auto const & s : spheres)
+            {
+                auto const c = s.xyz() - ro;
+                auto const middle = dot(c, rd);
+                auto const h = dot(c, c) - middle * middle - s.w * s.w;
+                if (h >= 0)
+                {
+                    continue;
+                }
+                auto const half = std::sqrt(-h);
+                if (middle - half <= t && middle + half > t)
+                {
+                    t = middle + half;
+                    next.push_back(s);
+                }
+            }
+            return t;
+        }
+
+        auto add(vec3 p, float radius)
+        {
+            next.push_back(vec4(p, radius));
+        }
+
+        auto end()
+        {
+            std::swap(spheres, next);
+        }
+    };
+
+    inline auto bound(float d)
+    {
+        return d;
+    }
+
+    inline auto bound(vec2 d)
+    {
+        return d.x;
+    }
+
+    // Over-relaxed sphere tracing (Keinert et al., Enhanced Sphere Tracing, 2014). Steps of
+    // relaxation times the distance are taken until two consecutive spheres stop
+    // overlapping, which means a step may have jumped over a surface; then the ray goes
+    // back to where a plain step would have ended and continues without relaxation.
+    // march wraps this with the budget and the counters, kept apart so that the loop stays
+    // small enough for the field to be inlined into it.
+    inline auto trace(vec3 ro, vec3 rd, auto field, settings const & s, int limit, coherence * cache)
+    {
+        auto t = cache ? cache->begin(ro, rd) : 0.f;
+        auto relaxation = std::max(s.relaxation, 1.f);
+        auto previous = 0.f; // radius at the last point
+        auto step = 0.f;
+
+        auto r = result<decltype(field(ro))>{t, {}, 0, false};
+        while (r.steps < limit)
+        {
+            auto const p = ro + rd * t;
+            r.t = t;
+            r.value = field(p);
+            ++r.steps;
+
+            auto const d = bound(r.value);
+            auto const radius = abs(d);
+            if (relaxation > 1 && radius + previous < step)
+            {
+                t -= step - step / relaxation;
+                relaxation = 1;
+                step = 0;
+                continue;
+            }
+            if (cache && d > 0)
+            {
+                cache->add(p, d);
+            }
+            if (radius < s.epsilon || (s.inside && d < 0))
+            {
+                r.hit = true;
+                break;
+            }
+
+            previous = radius;
+            step = d * relaxation;
+            t += step;
+            if (t > s.far)
+            {
+                break;
+            }
+        }
+        if (!r.hit)
+        {
+            r.t = t;
+        }
+
+        if (cache)
+        {
+            cache->end();
+        }
+        return r;
+    }
+
+    inline auto march(vec3 ro, vec3 rd, auto field, settings const & s = {}, coherence * cache = nullptr)
+    {
+        auto const limit = step_budget.allow(s.steps);
+        auto const r = trace(ro, rd, field, s, limit, cache);
+        step_budget.spend(r.steps);
+
+        auto & c = stats.local();
+        c.rays += 1;
+        c.steps += std::uint64_t(r.steps);
+        c.hits += r.hit;
+        c.starved += limit < s.steps;
+        c.max = std::max(c.max, r.steps);
+
+        return r;
+    }
+
+    struct packet_result
+    {
+        simd::lanes t; // per lane as in result
+        simd::lanes value;
+        simd::mask hit;
+        int steps; // of the longest ray, what the packet cost
+    };
+
+    // trace for a packet of rays, one per lane, that step together until the last of them is
+    // done. A lane that is done keeps its t while the field still runs for the others, which
+    // is what rays that diverge cost. far is settings::far per lane, lanes outside rays are
+    // done from the start. No coherence, its spheres follow one ray at a time.
+    inline auto trace(simd::vec3 const & ro, simd::vec3 const & rd, auto field, settings const & s, simd::lanes const & far, simd::mask const & rays, int limit, std::uint64_t & steps)
+    {
+        auto t = simd::lanes{};
+        auto relaxation = simd::lanes{std::max(s.relaxation, 1.f)};
+        auto previous = simd::lanes{};
+        auto step = simd::lanes{};
+        auto live = rays;
+
+        auto r = packet_result{};
+        while (r.steps < limit && any(live))
+        {
+            auto const d = field(ro + rd * t);
+            r.t = select(live, t, r.t);
+            r.value = select(live, d, r.value);
+            ++r.steps;
+            steps += count(live);
+
+            auto const radius = abs(d);
+            auto const back = live & (relaxation > 1.f) & (radius + previous < step);
+            t = select(back, t - (step - step / relaxation), t);
+            relaxation = select(back, 1.f, relaxation);
+            step = select(back, 0.f, step);
+
+            auto const hit = live & !back & ((radius < s.epsilon) | (s.inside ? d < 0.f : simd::mask{}));
+            r.hit = r.hit | hit;
+            live = live & !hit;
+
+            auto const moving = live & !back;
+            previous = select(moving, radius, previous);
+            step = select(moving, d * relaxation, step);
+            t = select(moving, t + step, t);
+            live = live & !(moving & (t > far));
+        }
+        r.t = select(r.hit, r.t, t);
+        return r;
+    }
+
+    // The packet's rays share one allowance of the budget and each of them is counted.
+    inline auto march(simd::vec3 const & ro, simd::vec3 const & rd, auto field, settings const & s, simd::lanes const & far, simd::mask const & rays = !simd::mask{})
+    {
+        auto const limit = step_budget.allow(s.steps);
+        auto steps = std::uint64_t{};
+        auto const r = trace(ro, rd, field, s, far, rays, limit, steps);
+        step_budget.spend(int(steps));
+
+        auto & c = stats.local();
+        c.rays += count(rays);
+        c.steps += steps;
+        c.hits += count(r.hit);
+        c.starved += limit < s.steps ? count(rays) : std::size_t{};
+        c.max = std::max(c.max, r.steps);
+
+        return r;
+    }
+
+    inline auto march(simd::vec3 const & ro, simd::vec3 const & rd, auto field, settings const & s = {})
+    {
+        return march(ro, rd, field, s, s.far);
+    }
+}
@@ -0,0 +1,403 @@
+#pragma once
+
+#include <w/math/approximate.hpp>
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+
+// Packets of adjacent fragments along a row, one per lane, for shaders with a mainImage
+// overload that takes them. lanes holds a float per fragment and basic_vec2, basic_vec3 and
+// basic_vec4 are the glsw vectors over any component type, vec2 to vec4 here over lanes.
+// Comparing lanes gives a mask, which stands in for a branch:
+//
+//     auto const hit = d < 0.001;
+//     colour = select(hit, lit, sky);
+//     while (any(!hit)) { ... }
+//
+// Every operation is a loop over the lanes that compilers vectorize. sin, exp and the other
+// functions USING_W_GLSW_AS picks come with their precision, from glsw.hpp, which includes
+// this header, so it needs nothing from it.
+namespace w::glsw::simd
+{
+    inline constexpr auto width = std::size_t
+    {
+#if defined(__AVX512F__)
+        16
+#elif defined(__AVX__)
+        8
+#else
+        4
+#endif
+    };
+
+    struct mask
+    {
+        std::array<bool, width> v;
+    };
+
+    struct lanes
+    {
+        std::array<float, width> v;
+
+        constexpr lanes() : v{}
+        {
+        }
+
+        constexpr lanes(float a) : v{}
+        {
+            v.fill(a);
+        }
+
+        constexpr auto operator[](std::size_t i) const
+        {
+            return v[i];
+        }
+
+        constexpr auto & operator[](std::size_t i)
+        {
+            return v[i];
+        }
+    };
+
+    constexpr auto each(auto f, lanes const & a)
+    {
+        auto r = lanes{};
+        for (auto i = std::size_t{}; i != width; ++i)
+        {
+            r.v[i] = f(a.v[i]);
+        }
+        return r;
+    }
+
+    constexpr auto each(auto f, lanes const & a, lanes const & b)
+    {
+        auto r = std::conditional_t<std::is_same_v<decltype(f(0.f, 0.f)), bool>, mask, lanes>{};
+        for (auto i = std::size_t{}; i != width; ++i)
+        {
+            r.v[i] = f(a.v[i], b.v[i]);
+        }
+        return r;
+    }
+
+#define W_GLSW_LANES_OPERATOR(op)                                                  \
+    constexpr auto operator op(lanes const & a, lanes const & b)                   \
+    {                                                                              \
+        return each([](float x, float y) { return x op y; }, a, b);                \
+    }                                                                              \
+    /**/
+#define W_GLSW_LANES_ASSIGNMENT(op)                                                \
+    W_GLSW_LANES_OPERATOR(op)                                                      \
+    constexpr auto & operator op##=(lanes & a, lanes const & b)                    \
+    {                                                                              \
+        return a = a op b;                                                         \
+    }                                                                              \
+    /**/
+
+    W_GLSW_LANES_ASSIGNMENT(+)
+    W_GLSW_LANES_ASSIGNMENT(-)
+    W_GLSW_LANES_ASSIGNMENT(*)
+    W_GLSW_LANES_ASSIGNMENT(/)
+    W_GLSW_LANES_OPERATOR(<)
+    W_GLSW_LANES_OPERATOR(>)
+    W_GLSW_LANES_OPERATOR(<=)
+    W_GLSW_LANES_OPERATOR(>=)
+
+#undef W_GLSW_LANES_ASSIGNMENT
+#undef W_GLSW_LANES_OPERATOR
+
+    constexpr auto operator-(lanes const & a)
+    {
+        return each([](float x) { return -x; }, a);
+    }
+
+    constexpr auto operator&(mask const & a, mask const & b)
+    {
+        auto r = mask{};
+        for (auto i = std::size_t{}; i != width; ++i)
+        {
+            r.v[i] = a.v[i] & b.v[i];
+        }
+        return r;
+    }
+
+    constexpr auto operator|(mask const & a, mask const & b)
+    {
+        auto r = mask{};
+        for (auto i = std::size_t{}; i != width; ++i)
+        {
+            r.v[i] = a.v[i] | b.v[i];
+        }
+        return r;
+    }
+
+    constexpr auto operator!(mask const & a)
+    {
+        auto r = mask{};
+        for (auto i = std::size_t{}; i != width; ++i)
+        {
+            r.v[i] = !a.v[i];
+        }
+        return r;
+    }
+
+    constexpr auto any(mask const & a)
+    {
+        auto r = false;
+        for (auto i = std::size_t{}; i != width; ++i)
+        {
+            r |= a.v[i];
+        }
+        return r;
+    }
+
+    constexpr auto all(mask const & a)
+    {
+        return !any(!a);
+    }
+
+    constexpr auto count(mask const & a)
+    {
+        auto r = std::size_t{};
+        for (auto i = std::size_t{}; i != width; ++i)
+        {
+            r += a.v[i];
+        }
+        return r;
+    }
+
+    // Per lane c ? a : b, both already computed.
+    constexpr auto select(mask const & c, lanes const & a, lanes const & b)
+    {
+        auto r = lanes{};
+        for (auto i = std::size_t{}; i != width; ++i)
+        {
+            r.v[i] = w::math::approximate::select(c.v[i], a.v[i], b.v[i]);
+        }
+        return r;
+    }
+
+    constexpr auto abs(lanes const & a)
+    {
+        return each(w::math::approximate::fabs, a);
+    }
+
+    inline auto sqrt(lanes const & a)
+    {
+        return each([](float x) { return std::sqrt(x); }, a);
+    }
+
+    constexpr auto min(lanes const & a, lanes const & b)
+    {
+        return each([](float x, float y) { return w::math::approximate::select(y < x, y, x); }, a, b);
+    }
+
+    constexpr auto max(lanes const & a, lanes const & b)
+    {
+        return each([](float x, float y) { return w::math::approximate::select(x < y, y, x); }, a, b);
+    }
+
+    constexpr auto clamp(lanes const & a, lanes const & low, lanes const & high)
+    {
+        return min(max(a, low), high);
+    }
+
+    // As glsw's mix, so that a packet overload shades like the scalar mainImage.
+    constexpr auto mix(lanes const & a, lanes const & b, lanes const & t)
+    {
+        return a * (1.f - t) + b * t;
+    }
+
+    // The glsw vectors over lanes or plain floats. A scalar glsw vector converts explicitly,
+    // into every lane.
+    template<typename T>
+    struct basic_vec2
+    {
+        T x;
+        T y;
+
+        constexpr basic_vec2() : x{}, y{}
+        {
+        }
+
+        constexpr basic_vec2(T a) : x{a}, y{a}
+        {
+        }
+
+        constexpr basic_vec2(T x, T y) : x{x}, y{y}
+        {
+        }
+
+        constexpr explicit basic_vec2(auto const & a) requires requires { T(a.x); T(a.y); } : x(a.x), y(a.y)
+        {
+        }
+    };
+
+    template<typename T>
+    struct basic_vec3
+    {
+        T x;
+        T y;
+        T z;
+
+        constexpr basic_vec3() : x{}, y{}, z{}
+        {
+        }
+
+        constexpr basic_vec3(T a) : x{a}, y{a}, z{a}
+        {
+        }
+
+        constexpr basic_vec3(T x, T y, T z) : x{x}, y{y}, z{z}
+        {
+        }
+
+        constexpr basic_vec3(basic_vec2<T> const & a, T z) : x{a.x}, y{a.y}, z{z}
+        {
+        }
+
+        constexpr explicit basic_vec3(auto const & a) requires requires { T(a.x); T(a.y); T(a.z); } : x(a.x), y(a.y), z(a.z)
+        {
+        }
+    };
+
+    template<typename T>
+    struct basic_vec4
+    {
+        T x;
+        T y;
+        T z;
+        T w;
+
+        constexpr basic_vec4() : x{}, y{}, z{}, w{}
+        {
+        }
+
+        constexpr basic_vec4(T a) : x{a}, y{a}, z{a}, w{a}
+        {
+        }
+
+        constexpr basic_vec4(T x, T y, T z, T w) : x{x}, y{y}, z{z}, w{w}
+        {
+        }
+
+        constexpr basic_vec4(basic_vec3<T> const & a, T w) : x{a.x}, y{a.y}, z{a.z}, w{w}
+        {
+        }
+
+        constexpr explicit basic_vec4(auto const & a) requires requires { T(a.x); T(a.y); T(a.z); T(a.w); } : x(a.x), y(a.y), z(a.z), w(a.w)
+        {
+        }
+    };
+
+    using vec2 = basic_vec2<lanes>;
+    using vec3 = basic_vec3<lanes>;
+    using vec4 = basic_vec4<lanes>;
+
+    template<typename T>
+    constexpr auto each(auto f, basic_vec2<T> const & a, basic_vec2<T> const & b) -> basic_vec2<T>
+    {
+        return {f(a.x, b.x), f(a.y, b.y)};
+    }
+
+    template<typename T>
+    constexpr auto each(auto f, basic_vec3<T> const & a, basic_vec3<T> const & b) -> basic_vec3<T>
+    {
+        return {f(a.x, b.x), f(a.y, b.y), f(a.z, b.z)};
+    }
+
+    template<typename T>
+    constexpr auto each(auto f, basic_vec4<T> const & a, basic_vec4<T> const & b) -> basic_vec4<T>
+    {
+        return {f(a.x, b.x), f(a.y, b.y), f(a.z, b.z), f(a.w, b.w)};
+    }
+
+#define W_GLSW_SIMD_OPERATOR(v, op)                                                           \
+    template<typename T>                                                                      \
+    constexpr auto operator op(v<T> const & a, v<T> const & b)                                \
+    {                                                                                         \
+        return each([](T const & x, T const & y) { return x op y; }, a, b);                   \
+    }                                                                                         \
+    template<typename T>                                                                      \
+    constexpr auto operator op(v<T> const & a, std::type_identity_t<T> const & b)             \
+    {                                                                                         \
+        return a op v<T>(b);                                                                  \
+    }                                                                                         \
+    template<typename T>                                                                      \
+    constexpr auto operator op(std::type_identity_t<T> const & a, v<T> const & b)             \
+    {                                                                                         \
+        return v<T>(a) op b;                                                                  \
+    }                                                                                         \
+    template<typename T>                                                                      \
+    constexpr auto & operator op##=(v<T> & a, v<T> const & b)                                 \
+    {                                                                                         \
+        return a = a op b;                                                                    \
+    }                                                                                         \
+    /**/
+#define W_GLSW_SIMD_OPERATORS(v)  \
+    W_GLSW_SIMD_OPERATOR(v, +)    \
+    W_GLSW_SIMD_OPERATOR(v, -)    \
+    W_GLSW_SIMD_OPERATOR(v, *)    \
+    W_GLSW_SIMD_OPERATOR(v, /)    \
+    template<typename T>          \
+    constexpr auto operator-(v<T> const & a) \
+    {                             \
+        return v<T>(T{}) - a;     \
+    }                             \
+    /**/
+
+    W_GLSW_SIMD_OPERATORS(basic_vec2)
+    W_GLSW_SIMD_OPERATORS(basic_vec3)
+    W_GLSW_SIMD_OPERATORS(basic_vec4)
+
+#undef W_GLSW_SIMD_OPERATORS
+#undef W_GLSW_SIMD_OPERATOR
+
+    template<typename T>
+    constexpr auto dot(basic_vec2<T> const & a, basic_vec2<T> const & b)
+    {
+        return a.x * b.x + a.y * b.y;
+    }
+
+    template<typename T>
+    constexpr auto dot(basic_vec3<T> const & a, basic_vec3<T> const & b)
+    {
+        return a.x * b.x + a.y * b.y + a.z * b.z;
+    }
+
+    template<typename T>
+    constexpr auto dot(basic_vec4<T> const & a, basic_vec4<T> const & b)
+    {
+        return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+    }
+
+    auto length(auto const & a)
+    {
+        using std::sqrt;
+        return sqrt(dot(a, a));
+    }
+
+    auto normalize(auto const & a)
+    {
+        return a / length(a);
+    }
+
+    template<template<typename> typename V, typename T>
+    constexpr auto mix(V<T> const & a, V<T> const & b, std::type_identity_t<T> const & t)
+    {
+        return a * (T(1.f) - t) + b * t;
+    }
+
+    template<template<typename> typename V>
+    constexpr auto select(mask const & c, V<lanes> const & a, V<lanes> const & b)
+    {
+        return each([&](lanes const & x, lanes const & y) { return select(c, x, y); }, a, b);
+    }
+
+    template<template<typename> typename V, typename T>
+    constexpr auto reflect(V<T> const & a, V<T> const & b)
+    {
+        return a - T(2.f) * dot(b, a) * b;
+    }
+}
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <w/glsw.hpp>
+
+#if defined(_WIN32)
+#    include <w/windows/mapped_file.hpp>
+#else
+#    include <w/posix/mapped_file.hpp>
+#endif
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+// Decoded textures saved exactly as sampler2D holds them, so the next run maps the file
+// and samples from it without decoding. Files are named after a hash of the source bytes
+// and only ever read on the machine that wrote them, hence native byte order.
+namespace w::glsw
+{
+#if defined(_WIN32)
+    using mapped_file = w::windows::mapped_file;
+#else
+    using mapped_file = w::posix::mapped_file;
+#endif
+
+    namespace texture_cache
+    {
+        inline constexpr auto magic = std::array<char, 8>{'g', 'l', 's', 'w', 't', 'e', 'x', '1'};
+
+        struct header
+        {
+            std::array<char, 8> magic;
+            std::uint32_t layout;
+            std::uint32_t levels;
+            std::uint64_t texels;
+        };
+
+        struct level
+        {
+            std::uint64_t width;
+            std::uint64_t height;
+            std::uint64_t offset;
+        };
+
+        // Texels start on a cache line.
+        inline constexpr auto alignment = std::size_t{64};
+
+        // More than a full mip chain of any size_t extent has.
+        inline constexpr auto max_levels = std::uint32_t{64};
+
+        inline auto data_offset(std::size_t levels)
+        {
+            return (sizeof(header) + levels * sizeof(level) + alignment - 1) / alignment * alignment;
+        }
+
+        // Whether the texels of l, as sampler2D lays them out, lie within the first texels,
+        // checked without overflowing on whatever a damaged file holds.
+        inline auto fits(level const & l, texel_layout layout, std::uint64_t texels)
+        {
+            auto const blocks = layout == texel_layout::blocks;
+            auto const width = blocks ? l.width / 4 + (l.width % 4 != 0) : l.width;
+            auto const height = blocks ? l.height / 4 + (l.height % 4 != 0) : l.height;
+            auto const size = std::uint64_t{blocks ? 16u : 1u};
+            return l.offset <= texels && (width == 0 || height <= (texels - l.offset) / size / width);
+        }
+
+        // FNV-1a, good enough to tell edits of the same image apart.
+        inline auto hash(std::span<std::byte const> bytes)
+        {
+            auto result = std::uint64_t{14695981039346656037u};
+            for (auto const b : bytes)
+            {
+                result = (result ^ std::uint64_t(b)) * 1099511628211u;
+            }
+            return result;
+        }
+
+        inline auto save(sampler2D const & s, std::filesystem::path const & path)
+        {
+            auto const levels = s.levels();
+            auto const texels = s.data();
+
+            auto const h = header{magic, std::uint32_t(s.get_layout()), std::uint32_t(levels.size()), texels.size()};
+            auto bytes = std::vector<char>(data_offset(levels.size()));
+            std::memcpy(bytes.data(), &h, sizeof(h));
+            for (auto i = std::size_t{}; i != levels.size(); ++i)
+            {
+                auto const l = level{levels[i].width, levels[i].height, levels[i].offset};
+                std::memcpy(bytes.data() + sizeof(h) + i * sizeof(l), &l, sizeof(l));
+            }
+
+            // Written aside and renamed, a relaunch racing this one never maps half a file. The
+            // name is this save's own, so two of them don't write into the same one either.
+            auto const temporary = std::filesystem::path{path}.concat("." + std::to_string(std::random_device{}()) + ".tmp");
+            try
+            {
+                {
+                    auto o = std::ofstream{temporary, std::ios::binary};
+                    o.write(bytes.data(), std::streamsize(bytes.size()));
+                    o.write(reinterpret_cast<char const *>(texels.data()), std::streamsize(texels.size_bytes()));
+                    if (!o)
+                    {
+                        throw std::runtime_error("cannot write " + temporary.string());
+                    }
+                }
+                std::filesystem::rename(temporary, path);
+            }
+            catch (...)
+            {
+                auto error = std::error_code{};
+                std::filesystem::remove(temporary, error);
+                throw;
+            }
+        }
+
+        // False when the file is not a cache file of this version, is truncated or has a level
+        // outside its texels.
+        inline auto load(sampler2D & s, std::shared_ptr<mapped_file const> file)
+        {
+            auto const bytes = file->bytes();
+
+            auto h = header{};
+            if (bytes.size() < sizeof(h))
+            {
+                return false;
+            }
+            std::memcpy(&h, bytes.data(), sizeof(h));
+
+            if (h.magic != magic || h.layout > std::uint32_t(texel_layout::blocks) || h.levels > max_levels)
+            {
+                return false;
+            }
+            auto const offset = data_offset(h.levels);
+            if (bytes.size() < offset || h.texels > (bytes.size() - offset) / sizeof(vec4))
+            {
+                return false;
+            }
+
+            auto levels = std::vector<sampler2D::level>(h.levels);
+            for (auto i = std::size_t{}; i != levels.size(); ++i)
+            {
+                auto l = level{};
+                std::memcpy(&l, bytes.data() + sizeof(h) + i * sizeof(l), sizeof(l));
+                if (!fits(l, texel_layout(h.layout), h.texels))
+                {
+                    return false;
+                }
+                levels[i] = {std::size_t(l.width), std::size_t(l.height), std::size_t(l.offset)};
+            }
+
+            auto const texels = std::span{reinterpret_cast<vec4 const *>(bytes.data() + offset), std::size_t(h.texels)};
+            s.adopt(levels, texels, texel_layout(h.layout), std::move(file));
+            return true;
+        }
+    }
+
+    // Maps the cached copy of source from directory when there is one, otherwise calls
+    // decode(s, source_bytes, layout) and caches the result for the next run.
+    inline auto load_cached(sampler2D & s, std::filesystem::path const & source, std::filesystem::path const & directory, texel_layout layout, auto decode)
+    {
+        auto const file = mapped_file{source};
+        auto const name = std::to_string(texture_cache::hash(file.bytes())) + "-" + std::to_string(int(layout)) + ".texture";
+        auto const cached = directory / name;
+
+        auto error = std::error_code{};
+        if (std::filesystem::exists(cached, error) && texture_cache::load(s, std::make_shared<mapped_file const>(cached)))
+        {
+            return;
+        }
+
+        decode(s, file.bytes(), layout);
+
+        // The cache only saves time, a read-only or full disk must not stop the texture.
+        try
+        {
+            std::filesystem::create_directories(directory);
+            texture_cache::save(s, cached);
+        }
+        catch (std::exception const &)
+        {
+        }
+    }
+}
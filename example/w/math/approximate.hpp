@@ -0,0 +1,260 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <numbers>
+
+// Polynomial approximations of the libm functions shaders spend their time in, behind
+// glsw::fast and glsw::mediump. Special cases are picked with select instead of branches,
+// which neighbouring fragments would mispredict, so loops over these also vectorize. Worst
+// errors against the exact result, as benchmark --check-math measures them, with absolute
+// errors where the result is below 1 in magnitude:
+//
+//               fast                                mediump
+//     exp       1 ulp                               2^-13 relative
+//     log       1 ulp                               2^-12 relative, 2^-12 absolute
+//     pow       3 + 2 |y ln x| ulp                  2^-11 (1 + |y ln x|) relative
+//     sin cos   2^-23 absolute, 2^-19 to |x| 2^16   2^-11 absolute
+//     atan      3 ulp                               2^-15 relative
+//     tanh      2 ulp                               2^-13 relative
+//
+// fast is what Cephes does for single precision. mediump is about what GLSL ES asks of
+// mediump, with fewer terms. Denormal results of exp are flushed to zero and denormal
+// arguments of log are taken as the smallest normal.
+// Where GLSL leaves a result undefined, like pow of a negative x or sin of a huge x, these
+// don't follow libm either.
+namespace w::math::approximate
+{
+    enum class precision
+    {
+        fast,
+        mediump
+    };
+
+    inline constexpr auto infinity = std::numeric_limits<float>::infinity();
+    inline constexpr auto nan = std::numeric_limits<float>::quiet_NaN();
+
+    // c ? a : b on the bits, both already computed, which compilers keep free of branches.
+    constexpr auto select(bool c, float a, float b)
+    {
+        auto const m = std::uint32_t{} - std::uint32_t{c};
+        return std::bit_cast<float>((std::bit_cast<std::uint32_t>(a) & m) | (std::bit_cast<std::uint32_t>(b) & ~m));
+    }
+
+    constexpr auto negative(float x)
+    {
+        return (std::bit_cast<std::uint32_t>(x) >> 31) != 0;
+    }
+
+    constexpr auto fabs(float x)
+    {
+        return std::bit_cast<float>(std::bit_cast<std::uint32_t>(x) & 0x7fffffffu);
+    }
+
+    // x within [low, high], high for NaN.
+    constexpr auto clamp(float x, float low, float high)
+    {
+        return select(x < high, select(x > low, x, low), high);
+    }
+
+    // Nearest integer, ties to even, for |x| < 2^22: adding 1.5 2^23 leaves no bits below the
+    // point. Further out it is some integer near x, up to 2^31.
+    constexpr auto nearest(float x)
+    {
+        constexpr auto shift = 12582912.f;
+        return std::int32_t((x + shift) - shift);
+    }
+
+    // p 2^k for k in [-252, 254], in two steps so that each power of two is normal and only
+    // the result is rounded, into a denormal or an infinity when it gets there.
+    constexpr auto scale(float p, std::int32_t k)
+    {
+        auto const a = k >> 1;
+        auto const b = k - a;
+        return p * std::bit_cast<float>(std::uint32_t(a + 127) << 23) * std::bit_cast<float>(std::uint32_t(b + 127) << 23);
+    }
+
+    template<precision P = precision::fast>
+    constexpr auto exp(float x)
+    {
+        // Below the smallest normal result it is flushed to 0, denormals are slow to get to.
+        // Above the largest scale overflows to infinity by itself.
+        constexpr auto low = -87.33654f;
+        auto const c = clamp(x, low, 89.f);
+
+        // e^x = 2^k e^r with |r| <= ln 2 / 2, ln 2 split so that k times the first part is exact.
+        auto const k = nearest(c * std::numbers::log2e_v<float>);
+        auto const r = c - float(k) * 0.693359375f - float(k) * -2.12194440e-4f;
+
+        auto p = 0.f;
+        if constexpr (P == precision::fast)
+        {
+            p = (((((1.9875691500e-4f * r + 1.3981999507e-3f) * r + 8.3334519073e-3f) * r + 4.1665795894e-2f) * r + 1.6666665459e-1f) * r + 5.0000001201e-1f) * r * r + r + 1;
+        }
+        else
+        {
+            p = ((1.651797571e-1f * r + 5.041303775e-1f) * r + 1.000195841f) * r + 1;
+        }
+
+        return select(x != x, x, select(x < low, 0.f, scale(p, k)));
+    }
+
+    template<precision P = precision::fast>
+    constexpr auto log(float x)
+    {
+        constexpr auto smallest = std::numeric_limits<float>::min();
+
+        // x = m 2^e with m in [sqrt(1/2), sqrt(2)), then log x = log(1 + f) + e ln 2 with f = m - 1.
+        auto const bits = std::bit_cast<std::uint32_t>(select(x > smallest, x, smallest));
+        auto const mantissa = bits & 0x7fffffu;
+        auto const high = mantissa > 0x3504f3u; // of sqrt(2)
+        auto const e = float(std::int32_t(bits >> 23) - 127 + high);
+        auto const f = std::bit_cast<float>(mantissa | (high ? 0x3f000000u : 0x3f800000u)) - 1;
+
+        auto r = 0.f;
+        if constexpr (P == precision::fast)
+        {
+            auto const z = f * f;
+            auto y = ((((((((7.0376836292e-2f * f - 1.1514610310e-1f) * f + 1.1676998740e-1f) * f - 1.2420140846e-1f) * f + 1.4249322787e-1f) * f - 1.6668057665e-1f) * f + 2.0000714765e-1f) * f - 2.4999993993e-1f) * f + 3.3333331174e-1f) * f * z;
+            y += -2.12194440e-4f * e;
+            y += -.5f * z;
+            r = f + y + 0.693359375f * e;
+        }
+        else
+        {
+            r = (((-2.326862924e-1f * f + 3.554008468e-1f) * f - 5.015920212e-1f) * f + 9.996748761e-1f) * f + e * std::numbers::ln2_v<float>;
+        }
+
+        r = select(x == infinity, x, r);
+        r = select(x == 0, -infinity, r);
+        return select((x < 0) | (x != x), nan, r);
+    }
+
+    // Through log, which is where the error grows with the size of the result.
+    template<precision P = precision::fast>
+    constexpr auto pow(float x, float y)
+    {
+        return select(y == 0, 1.f, exp<P>(y * log<P>(x)));
+    }
+
+    // x - k pi/2 with k the nearest integer, pi/2 split so that the first two products are
+    // exact while |k| < 2^16.
+    struct quadrant
+    {
+        float r;
+        std::int32_t k;
+    };
+
+    constexpr auto reduce(float x)
+    {
+        // Clamped only so that the conversion to int stays defined, the result is meaningless
+        // that far out anyway.
+        auto const c = clamp(x, -1e9f, 1e9f);
+        auto const k = nearest(c * (2 / std::numbers::pi_v<float>));
+        auto const r = ((c - float(k) * 1.5703125f) - float(k) * 4.837512969970703125e-4f) - float(k) * 7.54978995489188216e-8f;
+        return quadrant{r, k};
+    }
+
+    // sin and cos for |r| <= pi/4, then picked and signed by quadrant.
+    template<precision P>
+    constexpr auto sin_cos(quadrant q)
+    {
+        auto const r = q.r;
+        auto const z = r * r;
+
+        auto s = 0.f;
+        auto c = 0.f;
+        if constexpr (P == precision::fast)
+        {
+            s = ((-1.9515295891e-4f * z + 8.3321608736e-3f) * z - 1.6666654611e-1f) * z * r + r;
+            c = ((2.443315711809948e-5f * z - 1.388731625493765e-3f) * z + 4.166664568298827e-2f) * z * z - .5f * z + 1;
+        }
+        else
+        {
+            s = (-1.616011014e-1f * z + 9.996122813e-1f) * r;
+            c = (4.039853597e-2f * z - 4.997081404e-1f) * z + 9.999900350e-1f;
+        }
+
+        auto const v = select(q.k & 1, c, s);
+        return std::bit_cast<float>(std::bit_cast<std::uint32_t>(v) ^ (std::uint32_t(q.k & 2) << 30));
+    }
+
+    template<precision P = precision::fast>
+    constexpr auto sin(float x)
+    {
+        return select(x - x != 0, nan, sin_cos<P>(reduce(x))); // infinities and NaN
+    }
+
+    template<precision P = precision::fast>
+    constexpr auto cos(float x)
+    {
+        auto q = reduce(x);
+        q.k += 1;
+        return select(x - x != 0, nan, sin_cos<P>(q));
+    }
+
+    template<precision P = precision::fast>
+    constexpr auto atan(float x)
+    {
+        // Above tan 3pi/8 atan a = pi/2 - atan(1/a), above tan pi/8 atan a = pi/4 + atan((a - 1)/(a + 1)),
+        // which leaves |t| <= tan pi/8.
+        auto const a = fabs(x);
+        auto const big = a > 2.414213562373095f;
+        auto const middle = a > 0.4142135623730950f;
+        auto const t = select(big, -1 / select(big, a, 1.f), select(middle, (a - 1) / (a + 1), a));
+        auto const base = select(big, std::numbers::pi_v<float> / 2, select(middle, std::numbers::pi_v<float> / 4, 0.f));
+        auto const z = t * t;
+
+        auto p = 0.f;
+        if constexpr (P == precision::fast)
+        {
+            p = (((8.05374449538e-2f * z - 1.38776856032e-1f) * z + 1.99777106478e-1f) * z - 3.33329491539e-1f) * z * t + t;
+        }
+        else
+        {
+            p = ((1.683565107e-1f * z - 3.314125007e-1f) * z + 9.999824458e-1f) * t;
+        }
+
+        auto const r = base + p;
+        return select(negative(x), -r, r);
+    }
+
+    // Of y / x, in the quadrant of (x, y).
+    template<precision P = precision::fast>
+    constexpr auto atan2(float y, float x)
+    {
+        constexpr auto pi = std::numbers::pi_v<float>;
+        if (x == 0 && y == 0) // where y / x would be NaN
+        {
+            return negative(x) ? (negative(y) ? -pi : pi) : y;
+        }
+        auto const r = atan<P>(y / x);
+        return select(x < 0, r + select(negative(y), -pi, pi), r);
+    }
+
+    template<precision P = precision::fast>
+    constexpr auto tanh(float x)
+    {
+        // An odd polynomial near 0, 1 - 2 / (e^2|x| + 1) further out where it doesn't cancel.
+        auto const a = fabs(x);
+        auto const z = x * x;
+        auto const e = exp<P>(2 * a);
+        auto const far = 1 - 2 / (e + 1);
+
+        auto near = 0.f;
+        auto edge = 0.f;
+        if constexpr (P == precision::fast)
+        {
+            near = ((((-5.70498872745e-3f * z + 2.06390887954e-2f) * z - 5.37397155531e-2f) * z + 1.33314422036e-1f) * z - 3.33332819422e-1f) * z * x + x;
+            edge = .625f;
+        }
+        else
+        {
+            near = ((1.120324917e-1f * z - 3.310444929e-1f) * z + 9.999630168e-1f) * x;
+            edge = .55f;
+        }
+
+        return select(a < edge, near, select(negative(x), -far, far));
+    }
+}
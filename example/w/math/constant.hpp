@@ -0,0 +1,296 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <numbers>
+
+// libm for constant evaluation, where <cmath> is not constexpr before C++26. Everything is
+// computed in double, so float results round to what libm returns or one ulp off. At run
+// time the glsw wrappers call <cmath> instead, these are neither fast nor meant for huge
+// arguments.
+namespace w::math::constant
+{
+    inline constexpr auto nan = std::numeric_limits<double>::quiet_NaN();
+    inline constexpr auto infinity = std::numeric_limits<double>::infinity();
+
+    constexpr auto isnan(double x)
+    {
+        return x != x;
+    }
+
+    constexpr auto signbit(double x)
+    {
+        return (std::bit_cast<std::uint64_t>(x) >> 63) != 0;
+    }
+
+    constexpr auto fabs(double x)
+    {
+        return signbit(x) ? -x : x;
+    }
+
+    constexpr auto trunc(double x)
+    {
+        return isnan(x) || fabs(x) >= 0x1p52 ? x : double(static_cast<long long>(x));
+    }
+
+    constexpr auto floor(double x)
+    {
+        auto const t = trunc(x);
+        return t > x ? t - 1 : t;
+    }
+
+    constexpr auto ceil(double x)
+    {
+        auto const t = trunc(x);
+        return t < x ? t + 1 : t;
+    }
+
+    // Half away from zero, like std::round.
+    constexpr auto round(double x)
+    {
+        return x < 0 ? -floor(-x + .5) : floor(x + .5);
+    }
+
+    // x * 2^e, one power of two at a time, which is exact short of overflow and
+    // denormals.
+    constexpr auto ldexp(double x, int e)
+    {
+        for (; e > 0; --e)
+        {
+            x *= 2;
+        }
+        for (; e < 0; ++e)
+        {
+            x /= 2;
+        }
+        return x;
+    }
+
+    constexpr auto sqrt(double x)
+    {
+        if (isnan(x) || x < 0)
+        {
+            return nan;
+        }
+        if (x == 0 || x == infinity)
+        {
+            return x;
+        }
+
+        // Scales into [1, 4) by powers of four, where Newton converges from 1.5 in a few
+        // steps, then scales the root back by the powers of two.
+        auto e = 0;
+        for (; x >= 4; x /= 4)
+        {
+            ++e;
+        }
+        for (; x < 1; x *= 4)
+        {
+            --e;
+        }
+        auto r = 1.5;
+        for (auto i = 0; i != 6; ++i)
+        {
+            r = (r + x / r) / 2;
+        }
+        return ldexp(r, e);
+    }
+
+    constexpr auto exp(double x)
+    {
+        if (isnan(x))
+        {
+            return x;
+        }
+        if (x > 709.8)
+        {
+            return infinity;
+        }
+        if (x < -745.2)
+        {
+            return 0.;
+        }
+
+        // e^x = 2^k e^r with |r| <= ln 2 / 2, where the series converges within 20 terms.
+        auto const k = round(x / std::numbers::ln2);
+        auto const r = x - k * std::numbers::ln2;
+        auto sum = 1.;
+        auto term = 1.;
+        for (auto n = 1; n != 20; ++n)
+        {
+            term *= r / n;
+            sum += term;
+        }
+        return ldexp(sum, int(k));
+    }
+
+    constexpr auto log(double x)
+    {
+        if (isnan(x) || x < 0)
+        {
+            return nan;
+        }
+        if (x == 0)
+        {
+            return -infinity;
+        }
+        if (x == infinity)
+        {
+            return x;
+        }
+
+        // x = m 2^e with m in [sqrt(1/2), sqrt(2)), then log m = 2 atanh((m - 1) / (m + 1)).
+        auto e = 0;
+        for (; x >= std::numbers::sqrt2; x /= 2)
+        {
+            ++e;
+        }
+        for (; x < std::numbers::sqrt2 / 2; x *= 2)
+        {
+            --e;
+        }
+        auto const s = (x - 1) / (x + 1);
+        auto const s2 = s * s;
+        auto sum = 0.;
+        auto term = s;
+        for (auto n = 1; n < 40; n += 2)
+        {
+            sum += term / n;
+            term *= s2;
+        }
+        return 2 * sum + e * std::numbers::ln2;
+    }
+
+    constexpr auto pow(double x, double y)
+    {
+        if (y == 0)
+        {
+            return 1.;
+        }
+        if (isnan(x) || isnan(y))
+        {
+            return nan;
+        }
+        if (x == 0)
+        {
+            return y < 0 ? infinity : 0.;
+        }
+        if (x < 0)
+        {
+            if (trunc(y) != y)
+            {
+                return nan;
+            }
+            auto const odd = fabs(y) < 0x1p53 && static_cast<long long>(y) % 2 != 0;
+            auto const result = exp(y * log(-x));
+            return odd ? -result : result;
+        }
+        return exp(y * log(x));
+    }
+
+    // sin and cos of x reduced by the nearest multiple of pi/2, which is accurate while x
+    // is within a few thousand radians.
+    constexpr auto sin_cos_reduced(double r, bool cosine)
+    {
+        auto const r2 = r * r;
+        auto sum = cosine ? 1. : r;
+        auto term = sum;
+        for (auto n = cosine ? 1 : 2; n < 30; n += 2)
+        {
+            term *= -r2 / (n * (n + 1));
+            sum += term;
+        }
+        return sum;
+    }
+
+    constexpr auto sin(double x)
+    {
+        if (isnan(x) || fabs(x) == infinity)
+        {
+            return nan;
+        }
+        auto const k = round(x / (std::numbers::pi / 2));
+        auto const r = x - k * (std::numbers::pi / 2);
+        switch (static_cast<long long>(k) & 3)
+        {
+            case 0:
+                return sin_cos_reduced(r, false);
+            case 1:
+                return sin_cos_reduced(r, true);
+            case 2:
+                return -sin_cos_reduced(r, false);
+            default:
+                return -sin_cos_reduced(r, true);
+        }
+    }
+
+    constexpr auto cos(double x)
+    {
+        return sin(x + std::numbers::pi / 2);
+    }
+
+    constexpr auto atan(double x)
+    {
+        if (isnan(x))
+        {
+            return x;
+        }
+        if (fabs(x) > 1)
+        {
+            return (x > 0 ? std::numbers::pi / 2 : -std::numbers::pi / 2) - atan(1 / x);
+        }
+
+        // atan x = 2 atan(x / (1 + sqrt(1 + x^2))), twice, leaves |x| below 0.2.
+        auto scale = 1.;
+        for (auto i = 0; i != 2; ++i)
+        {
+            x = x / (1 + sqrt(1 + x * x));
+            scale *= 2;
+        }
+        auto const x2 = x * x;
+        auto sum = 0.;
+        auto term = x;
+        for (auto n = 1; n < 41; n += 2)
+        {
+            sum += term / n;
+            term *= -x2;
+        }
+        return scale * sum;
+    }
+
+    constexpr auto atan2(double y, double x)
+    {
+        if (isnan(x) || isnan(y))
+        {
+            return nan;
+        }
+        if (x > 0)
+        {
+            return atan(y / x);
+        }
+        if (x < 0)
+        {
+            return atan(y / x) + (signbit(y) ? -std::numbers::pi : std::numbers::pi);
+        }
+        return y > 0 ? std::numbers::pi / 2 : y < 0 ? -std::numbers::pi / 2 : y;
+    }
+
+    constexpr auto tanh(double x)
+    {
+        if (isnan(x))
+        {
+            return x;
+        }
+        if (fabs(x) > 20)
+        {
+            return x > 0 ? 1. : -1.;
+        }
+        if (fabs(x) < 1e-5)
+        {
+            return x;
+        }
+        auto const e = exp(2 * x);
+        return (e - 1) / (e + 1);
+    }
+}
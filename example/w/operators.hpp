@@ -6,19 +6,19 @@
 
 namespace w::operators
 {
-    #define W_DEFINE_FRIEND_OPERATOR(T, op1) \
-        friend auto operator op1(T a, T b)   \
-        {                                    \
-            a op1 ## = b;                    \
-            return a;                        \
-        }                                    \
+    #define W_DEFINE_FRIEND_OPERATOR(T, op1)           \
+        friend constexpr auto operator op1(T a, T b) \
+        {                                            \
+            a op1 ## = b;                            \
+            return a;                                \
+        }                                            \
         /**/
 
     namespace tuple
     {
         #define W_TUPLE_OP(o) \
             template<typename ... T> \
-            auto & operator o(std::tuple<T...> & l, std::tuple<T...> const & r) \
+            constexpr auto & operator o(std::tuple<T...> & l, std::tuple<T...> const & r) \
             { \
                 return []<std::size_t ... I>(auto & l, auto & r, std::index_sequence<I...>) -> auto & \
                 { \
@@ -38,7 +38,7 @@ namespace w::operators
         #undef W_TUPLE_OP
 
         #define W_DEFINE_ARITHMETIC_ASSIGNMENT_OPERATORS_ONE(t, o) \
-            auto operator o(t a) \
+            constexpr auto operator o(t a) \
             { \
                 using namespace w::operators::tuple; \
                 auto self = tie(); \
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <w/default_move.hpp>
+#include <w/fatal_error.hpp>
+#include <w/move_assignment.hpp>
+#include <w/swap.hpp>
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace w::posix
+{
+    // A whole file mapped read-only, pages come in on first touch.
+    class mapped_file
+    {
+        default_move<void *> address;
+        default_move<std::size_t> length;
+
+    public:
+        explicit mapped_file(std::filesystem::path const & path)
+        {
+            auto const fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd == -1)
+            {
+                throw std::runtime_error("cannot open " + path.string());
+            }
+
+            struct stat st{};
+            auto const ok = ::fstat(fd, &st) == 0;
+            auto const size = ok ? std::size_t(st.st_size) : 0;
+            auto const a = ok && size ? ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0) : nullptr;
+            ::close(fd);
+
+            if (!ok || a == MAP_FAILED)
+            {
+                throw std::runtime_error("cannot map " + path.string());
+            }
+            if (a)
+            {
+                ::madvise(a, size, MADV_SEQUENTIAL);
+            }
+            address = a;
+            length = size;
+        }
+        mapped_file(mapped_file && other) noexcept = default;
+        W_DEFINE_MOVE_ASSIGNMENT(mapped_file)
+        W_DEFINE_SWAP(mapped_file, address, length)
+        ~mapped_file()
+        {
+            if (address && ::munmap(address, length) != 0)
+            {
+                fatal_error();
+            }
+        }
+
+        auto bytes() const
+        {
+            return std::span{static_cast<std::byte const *>(address.value), length.value};
+        }
+    };
+}
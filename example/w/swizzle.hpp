@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+
+// W_SWIZZLES(n, m, t, a, b, c, d) calls m(t, name, (members...)) for every name of 2 to 4
+// letters out of the first n of a, b, c, d, repeats included, with the members x, y, z or w
+// they stand for: 28 names for n = 2, 117 for 3 and 336 for 4. Every depth has its own
+// macros, since a macro doesn't expand within itself.
+#define W_SWIZZLES(n, m, t, a, b, c, d) W_SWIZZLE_EACH_##n##_1(W_SWIZZLE_LEVEL_1, n, m, t, , (), a, b, c, d)
+
+#define W_SWIZZLE_UNPACK(...) __VA_ARGS__
+
+#define W_SWIZZLE_LEVEL_1(n, m, t, p, q, a, b, c, d) W_SWIZZLE_EACH_##n##_2(W_SWIZZLE_LEVEL_2, n, m, t, p, q, a, b, c, d)
+#define W_SWIZZLE_LEVEL_2(n, m, t, p, q, a, b, c, d) m(t, p, q) W_SWIZZLE_EACH_##n##_3(W_SWIZZLE_LEVEL_3, n, m, t, p, q, a, b, c, d)
+#define W_SWIZZLE_LEVEL_3(n, m, t, p, q, a, b, c, d) m(t, p, q) W_SWIZZLE_EACH_##n##_4(W_SWIZZLE_LEVEL_4, n, m, t, p, q, a, b, c, d)
+#define W_SWIZZLE_LEVEL_4(n, m, t, p, q, a, b, c, d) m(t, p, q)
+
+#define W_SWIZZLE_EACH_2_1(f, n, m, t, p, q, a, b, c, d) f(n, m, t, a, (x), a, b, c, d) f(n, m, t, b, (y), a, b, c, d)
+#define W_SWIZZLE_EACH_3_1(f, n, m, t, p, q, a, b, c, d) W_SWIZZLE_EACH_2_1(f, n, m, t, p, q, a, b, c, d) f(n, m, t, c, (z), a, b, c, d)
+#define W_SWIZZLE_EACH_4_1(f, n, m, t, p, q, a, b, c, d) W_SWIZZLE_EACH_3_1(f, n, m, t, p, q, a, b, c, d) f(n, m, t, d, (w), a, b, c, d)
+
+#define W_SWIZZLE_EACH_2_2(f, n, m, t, p, q, a, b, c, d) f(n, m, t, p##a, (W_SWIZZLE_UNPACK q, x), a, b, c, d) f(n, m, t, p##b, (W_SWIZZLE_UNPACK q, y), a, b, c, d)
+#define W_SWIZZLE_EACH_3_2(f, n, m, t, p, q, a, b, c, d) W_SWIZZLE_EACH_2_2(f, n, m, t, p, q, a, b, c, d) f(n, m, t, p##c, (W_SWIZZLE_UNPACK q, z), a, b, c, d)
+#define W_SWIZZLE_EACH_4_2(f, n, m, t, p, q, a, b, c, d) W_SWIZZLE_EACH_3_2(f, n, m, t, p, q, a, b, c, d) f(n, m, t, p##d, (W_SWIZZLE_UNPACK q, w), a, b, c, d)
+
+#define W_SWIZZLE_EACH_2_3(f, n, m, t, p, q, a, b, c, d) f(n, m, t, p##a, (W_SWIZZLE_UNPACK q, x), a, b, c, d) f(n, m, t, p##b, (W_SWIZZLE_UNPACK q, y), a, b, c, d)
+#define W_SWIZZLE_EACH_3_3(f, n, m, t, p, q, a, b, c, d) W_SWIZZLE_EACH_2_3(f, n, m, t, p, q, a, b, c, d) f(n, m, t, p##c, (W_SWIZZLE_UNPACK q, z), a, b, c, d)
+#define W_SWIZZLE_EACH_4_3(f, n, m, t, p, q, a, b, c, d) W_SWIZZLE_EACH_3_3(f, n, m, t, p, q, a, b, c, d) f(n, m, t, p##d, (W_SWIZZLE_UNPACK q, w), a, b, c, d)
+
+#define W_SWIZZLE_EACH_2_4(f, n, m, t, p, q, a, b, c, d) f(n, m, t, p##a, (W_SWIZZLE_UNPACK q, x), a, b, c, d) f(n, m, t, p##b, (W_SWIZZLE_UNPACK q, y), a, b, c, d)
+#define W_SWIZZLE_EACH_3_4(f, n, m, t, p, q, a, b, c, d) W_SWIZZLE_EACH_2_4(f, n, m, t, p, q, a, b, c, d) f(n, m, t, p##c, (W_SWIZZLE_UNPACK q, z), a, b, c, d)
+#define W_SWIZZLE_EACH_4_4(f, n, m, t, p, q, a, b, c, d) W_SWIZZLE_EACH_3_4(f, n, m, t, p, q, a, b, c, d) f(n, m, t, p##d, (W_SWIZZLE_UNPACK q, w), a, b, c, d)
+
+namespace w::swizzle
+{
+    // Whether a swizzle can be written to, which it can't when a letter repeats.
+    template<std::size_t N>
+    constexpr auto distinct(char const (& name)[N])
+    {
+        for (auto i = std::size_t{}; i != N - 1; ++i)
+        {
+            for (auto j = i + 1; j != N - 1; ++j)
+            {
+                if (name[i] == name[j])
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // The components of a, in order, to the members a swizzle names.
+    constexpr auto assign(auto const & a, auto & x, auto & y)
+    {
+        x = a.x;
+        y = a.y;
+    }
+
+    constexpr auto assign(auto const & a, auto & x, auto & y, auto & z)
+    {
+        x = a.x;
+        y = a.y;
+        z = a.z;
+    }
+
+    constexpr auto assign(auto const & a, auto & x, auto & y, auto & z, auto & w)
+    {
+        x = a.x;
+        y = a.y;
+        z = a.z;
+        w = a.w;
+    }
+}
@@ -1,6 +1,6 @@
 #pragma once
 
-#define W_DEFINE_TIE(...)                              \
-    auto tie() { return std::tie(__VA_ARGS__); }       \
-    auto tie() const { return std::tie(__VA_ARGS__); } \
+#define W_DEFINE_TIE(...)                                        \
+    constexpr auto tie() { return std::tie(__VA_ARGS__); }       \
+    constexpr auto tie() const { return std::tie(__VA_ARGS__); } \
     /**/
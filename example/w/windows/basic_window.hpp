@@ -201,6 +201,14 @@ namespace w::windows
                     }
                 }
                 break;
+                case WM_HOTKEY:
+                {
+                    if (self->on_hotkey)
+                    {
+                        self->on_hotkey(int(w));
+                    }
+                }
+                break;
                 case WM_ERASEBKGND:
                 {
                     return TRUE;
@@ -253,6 +261,7 @@ namespace w::windows
     public:
         std::function<void(gdi::image &)> on_paint;
         std::function<void(int, int)> on_mouse_move;
+        std::function<void(int)> on_hotkey;
 
         explicit basic_window(std::string const & name, RECT r, DWORD ex_style = 0, DWORD style = WS_OVERLAPPEDWINDOW, int cmd_show = SW_SHOW) : 
             value{value_type::borrow, create(this, name, r, ex_style, style)},
@@ -282,6 +291,25 @@ namespace w::windows
             }
         }
 
+        auto set_title(std::string const & title) const
+        {
+            auto const ok = ::SetWindowTextA(value.get(), title.c_str());
+            if (ok)
+            {
+            }
+            else
+            {
+                throw std::runtime_error("::SetWindowTextA failed");
+            }
+        }
+
+        // Hot keys work without focus, which a WS_EX_NOACTIVATE window never gets. False when
+        // another program already holds the combination.
+        auto register_hotkey(int id, UINT modifiers, UINT key) const
+        {
+            return ::RegisterHotKey(value.get(), id, modifiers | MOD_NOREPEAT, key) != FALSE;
+        }
+
         auto dc() const -> gdi::scoped_dc
         {
             return gdi::scoped_dc(value.get());
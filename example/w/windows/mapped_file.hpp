@@ -0,0 +1,68 @@
+#pragma once
+
+#include <w/default_move.hpp>
+#include <w/fatal_error.hpp>
+#include <w/move_assignment.hpp>
+#include <w/swap.hpp>
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <stdexcept>
+#include <string>
+
+#include <Windows.h>
+
+namespace w::windows
+{
+    // A whole file mapped read-only, pages come in on first touch.
+    class mapped_file
+    {
+        default_move<void const *> address;
+        default_move<std::size_t> length;
+
+    public:
+        explicit mapped_file(std::filesystem::path const & path)
+        {
+            auto const file = ::CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+            if (file == INVALID_HANDLE_VALUE)
+            {
+                throw std::runtime_error("cannot open " + path.string());
+            }
+
+            auto size = LARGE_INTEGER{};
+            auto const ok = ::GetFileSizeEx(file, &size);
+            auto const mapping = ok && size.QuadPart ? ::CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+            auto const a = mapping ? ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+
+            // The view keeps the mapping and the file alive on its own.
+            if (mapping)
+            {
+                ::CloseHandle(mapping);
+            }
+            ::CloseHandle(file);
+
+            if (!ok || (size.QuadPart && !a))
+            {
+                throw std::runtime_error("cannot map " + path.string());
+            }
+            address = a;
+            length = std::size_t(size.QuadPart);
+        }
+        mapped_file(mapped_file && other) noexcept = default;
+        W_DEFINE_MOVE_ASSIGNMENT(mapped_file)
+        W_DEFINE_SWAP(mapped_file, address, length)
+        ~mapped_file()
+        {
+            if (address && !::UnmapViewOfFile(address))
+            {
+                fatal_error();
+            }
+        }
+
+        auto bytes() const
+        {
+            return std::span{static_cast<std::byte const *>(address.value), length.value};
+        }
+    };
+}